@@ -9,7 +9,7 @@ namespace JKA::executor
 
     CommandExecutionResult AdvancedCommandExecutor::execute(const Command& command)
     {
-        auto it = overloads.find(command.name);
+        auto it = overloads.find(std::string_view(command.name));
         if (it == overloads.end()) {
             return CommandExecutionResult::fail_unknown_command();
         }
@@ -279,9 +279,9 @@ namespace JKA::executor {
             static constexpr ArgKind kind = ArgKind::ACTIVE;
             static constexpr ArgFlags flags = ArgFlags::NO_FLAGS;
 
-            static const std::string& extract_arg(const CommandParser::Command& cmd, size_t active_arg_idx)
+            static std::string extract_arg(const CommandParser::Command& cmd, size_t active_arg_idx)
             {
-                return cmd.args[active_arg_idx].getStr();
+                return std::string(cmd.args[active_arg_idx].getStr());
             }
 
             static const CallbackArgInfoActiveSimple& get_info()
@@ -380,7 +380,7 @@ namespace JKA::executor {
 
             static CommandName extract_arg(const CommandParser::Command& cmd, size_t)
             {
-                return CommandName{ cmd.name };
+                return CommandName{ std::string(cmd.name) };
             }
 
             static const CallbackArgInfoPassiveCommandName& get_info()
@@ -697,7 +697,7 @@ namespace JKA::executor {
     class AdvancedCommandExecutor {
     public:
         using Command = CommandParser::Command;
-        using Arguments = std::vector<CommandParser::Argument>;
+        using Arguments = std::pmr::vector<CommandParser::Argument>;
         using Callback = std::function<void(const Command& command)>;
 
         AdvancedCommandExecutor() = default;
@@ -0,0 +1,65 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "Huffman.h"
+#include "JKAInfo.h"
+#include "ServerAddress.h"
+#include "SharedDefs.h"
+#include "packets/ConnlessPacketView.h"
+#include "utility/Span.h"
+
+namespace JKA {
+    // Stateless getchallenge handling: the challenge is a MAC of the client's
+    // address, port and the current time bucket, so nothing is stored until a
+    // connect with a valid challenge comes in (JKA keeps a table of
+    // MAX_CHALLENGES pending challenges instead). The challenges are ints, the same
+    // as the ones in challengeResponse, in the connect userinfo and in the
+    // netchan encoders.
+    // A challenge is accepted during the bucket it was made in and the next one.
+    // After rotate(), the challenges made with the previous secret are still
+    // accepted until the next rotate().
+    class ChallengeCookies {
+    public:
+        using Secret = std::array<uint64_t, 2>;
+        using Duration = std::chrono::milliseconds;
+
+        explicit ChallengeCookies(const Secret & secret_, Duration bucket_ = Duration{ 10000 });
+        ChallengeCookies(const ChallengeCookies &) = default;
+        ChallengeCookies(ChallengeCookies &&) noexcept = default;
+        ChallengeCookies & operator=(const ChallengeCookies &) = default;
+        ChallengeCookies & operator=(ChallengeCookies &&) noexcept = default;
+        ~ChallengeCookies() = default;
+
+        // From std::random_device
+        static Secret randomSecret();
+
+        void rotate(const Secret & newSecret) noexcept;
+
+        int32_t make(const ServerAddress & from, TimePoint now) const noexcept;
+        bool verify(const ServerAddress & from, int32_t challenge, TimePoint now) const noexcept;
+        // The challenge as a decimal string, as in the connect userinfo
+        bool verify(const ServerAddress & from, std::string_view challenge, TimePoint now) const noexcept;
+
+        // Writes the challengeResponse to a getchallenge, returns its size
+        // (0 if the buffer is too small)
+        size_t respond(const ServerAddress & from, TimePoint now, Utility::Span<char> buffer) const noexcept;
+
+        // The userinfo of a connect, if its challenge is valid.
+        // Only then is the connect worth any state.
+        std::optional<JKAInfo> acceptConnect(const ServerAddress & from, const Packets::ConnectView & connect,
+                                             Q3Huffman & huff, TimePoint now) const;
+
+    private:
+        static int32_t mac(const Secret & key, const ServerAddress & from, uint64_t bucketIdx) noexcept;
+        uint64_t bucketOf(TimePoint now) const noexcept;
+
+        Secret secret;
+        Secret previousSecret;
+        bool hasPrevious = false;
+        Duration bucket;
+    };
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "SharedDefs.h"
+#include "jka/JKADefsNet.h"
+#include "jka/JKAEvents.h"
+
+namespace JKA {
+    // A single change made by the parser to the client's view of the server
+    struct ChangeRecord {
+        enum class Kind : uint8_t {
+            GAMESTATE,       // New gamestate: everything before is obsolete
+            CONFIGSTRING,    // number: index, text: new value
+            ENTITY_ADDED,    // number: entity, changedFields
+            ENTITY_CHANGED,  // number: entity, changedFields
+            ENTITY_REMOVED,  // number: entity
+            EVENT,           // number: entity, event, eventParm
+            SERVER_COMMAND,  // number: command sequence, text: command
+        };
+
+        uint64_t sequence = 0;  // Of the record in the journal, starting at 1
+        Kind kind = Kind::GAMESTATE;
+        // Entity records: the snapshot they came with.
+        // Others: the last snapshot parsed before them.
+        int32_t messageNum = 0;
+        int32_t number = 0;
+        EntityFieldMask changedFields{};
+        entity_event_t event = entity_event_t::EV_NONE;
+        int32_t eventParm = 0;
+        std::string text{};
+    };
+
+    // A ring of the last ChangeRecords appended by a ServerPacketParser
+    // (see ServerPacketParser::setJournal), read by any number of
+    // subscribers at their own pace. The parser never waits for them:
+    // a subscriber that falls more than capacity() records behind loses
+    // its place and has to resync from the full state (ClientGameState).
+    // Not thread-safe: read it on the parser's thread.
+    class ChangeJournal {
+    public:
+        static constexpr size_t DEFAULT_CAPACITY = 8192;
+
+        // A subscriber's position in the journal
+        struct Cursor {
+            uint64_t next = 1;
+        };
+
+        enum class ReadStatus {
+            OK,      // Every record up to the end has been read
+            MORE,    // maxRecords were read, there is more
+            RESYNC,  // The cursor fell behind and was moved to the end
+        };
+
+        explicit ChangeJournal(size_t capacity = DEFAULT_CAPACITY);
+        ChangeJournal(const ChangeJournal &) = default;
+        ChangeJournal(ChangeJournal &&) noexcept = default;
+        ChangeJournal & operator=(const ChangeJournal &) = default;
+        ChangeJournal & operator=(ChangeJournal &&) noexcept = default;
+        ~ChangeJournal() = default;
+
+        // Starts at the next appended record
+        Cursor subscribe() const noexcept
+        {
+            return Cursor{ nextSequence };
+        }
+
+        // f(const ChangeRecord &) for the records after the cursor
+        template<typename F>
+        ReadStatus read(Cursor & cursor, F && f, size_t maxRecords = std::numeric_limits<size_t>::max()) const
+        {
+            if (nextSequence - cursor.next > records.size()) JKA_UNLIKELY {
+                cursor.next = nextSequence;
+                return ReadStatus::RESYNC;
+            }
+
+            for (size_t count = 0; cursor.next < nextSequence; count++) {
+                if (count == maxRecords) {
+                    return ReadStatus::MORE;
+                }
+
+                f(records[cursor.next % records.size()]);
+                cursor.next++;
+            }
+            return ReadStatus::OK;
+        }
+
+        // Records not read by the cursor yet
+        uint64_t pending(const Cursor & cursor) const noexcept
+        {
+            return nextSequence - cursor.next;
+        }
+
+        size_t capacity() const noexcept
+        {
+            return records.size();
+        }
+
+        // The sequence the next record will get
+        uint64_t nextRecordSequence() const noexcept
+        {
+            return nextSequence;
+        }
+
+        // Parser
+        void appendGamestate(int32_t messageNum);
+        void appendConfigString(int32_t messageNum, size_t index, std::string_view value);
+        void appendEntity(ChangeRecord::Kind kind, int32_t messageNum,
+                          int32_t entityNum, const EntityFieldMask & changedFields);
+        void appendEvent(int32_t messageNum, int32_t entityNum, entity_event_t event, int32_t eventParm);
+        void appendServerCommand(int32_t messageNum, int32_t commandSequence, std::string_view command);
+
+    private:
+        // Overwrites the oldest record, reusing its text's capacity
+        ChangeRecord & append(ChangeRecord::Kind kind, int32_t messageNum, int32_t number) noexcept;
+
+        std::vector<ChangeRecord> records;
+        uint64_t nextSequence = 1;
+    };
+}
@@ -2,13 +2,18 @@
 #include <array>
 #include <cinttypes>
 #include <map>
+#include <memory_resource>
 #include <string>
 #include <string_view>
 
 #include "CEntity.h"
 #include "CommandExecutor.h"
+#include "ConfigStringViews.h"
+#include "EntityGrid.h"
+#include "EntitySet.h"
 #include "jka/JKADefs.h"
 #include "JKAInfo.h"
+#include "ParseEntitiesRing.h"
 #include "Snapshot.h"
 #include "SharedDefs.h"
 #include "jka/JKAEnums.h"
@@ -19,6 +24,15 @@ namespace JKA {
     // A dataclass that represents the client's view on a server's world
     struct ClientGameState {
         ClientGameState() = default;
+        // The infostrings, configstrings and their views are allocated from resource
+        explicit ClientGameState(std::pmr::memory_resource *resource) :
+            info(resource),
+            configStrings(resource),
+            configStringsInfo(resource),
+            configStringViews(resource)
+        {
+        }
+
         ClientGameState(const ClientGameState &) = delete;  // Too heavy
         ClientGameState(ClientGameState &&) = default;
         ClientGameState & operator=(const ClientGameState &) = delete;  // Too heavy
@@ -32,16 +46,20 @@ namespace JKA {
 
             configStrings.clear();
             configStringsInfo.clear();
+            configStringsVersion++;
+            configStringViews.clear();
 
             // Entities
             entityBaselines.fill({});
-            parseEntities.fill({});
+            parseEntities.reset();
             currentEntities.fill({});
+            activeEntities.clear();
+            entityGrid.clear();
 
             // Snapshots
             clientNum = 0;
-            curSnap = {};
             snapshots.fill({});
+            curSnapIndex = 0;
             parseEntitiesNum = 0;
             serverTime = 0;
 
@@ -52,8 +70,10 @@ namespace JKA {
         // Gamestate-related data
         JKAInfo info{};
 
-        std::map<size_t, std::string, std::less<>> configStrings{};
-        std::map<size_t, JKAInfo, std::less<>> configStringsInfo{};
+        std::pmr::map<size_t, std::pmr::string, std::less<>> configStrings{};
+        std::pmr::map<size_t, JKAInfo, std::less<>> configStringsInfo{};
+        uint64_t configStringsVersion = 0;  // Changes along with configStrings
+        ConfigStringViews configStringViews{};  // Typed views of some configStrings
 
         std::string_view getConfigString(size_t index) const &
         {
@@ -65,16 +85,32 @@ namespace JKA {
             }
         }
         
-        void setConfigString(size_t index, std::string_view newValue)
+        void setConfigString(size_t index, std::string_view newValue, bool parseInfo = true)
         {
             configStrings[index] = newValue;
-            configStringsInfo[index] = JKAInfo::fromInfostring(newValue);
+            configStringsVersion++;
+            if (parseInfo) {
+                auto & parsed = configStringsInfo[index];
+                parsed.assignInfostring(newValue);
+                configStringViews.update(index, newValue, &parsed);
+            } else {
+                configStringsInfo.erase(index);
+                configStringViews.update(index, newValue);
+            }
         }
         
         void clearConfigstrings()
         {
             configStrings.clear();
             configStringsInfo.clear();
+            configStringsVersion++;
+            configStringViews.clear();
+        }
+
+        // What the strings are allocated from
+        std::pmr::memory_resource *resource() const noexcept
+        {
+            return configStrings.get_allocator().resource();
         }
 
         JKAInfo *getConfigStringInfo(size_t index) &
@@ -87,15 +123,35 @@ namespace JKA {
             }
         }
 
+        // The index-th entity of a frame whose entities start at parseNum
+        // (e.g. clSnapshot_t::parseEntitiesNum)
+        const entityState_t & parsedEntity(size_t parseNum, size_t index = 0) const &
+        {
+            return parseEntities[parseNum + index];
+        }
+
+        // Snapshots are parsed in place into snapshots[messageNum & PACKET_MASK]
+        const Snapshot & curSnap() const & noexcept
+        {
+            return snapshots[curSnapIndex];
+        }
+
+        Snapshot & curSnap() & noexcept
+        {
+            return snapshots[curSnapIndex];
+        }
+
         // Entities
         std::array<entityState_t, MAX_GENTITIES> entityBaselines{};
-        std::array<entityState_t, MAX_PARSE_ENTITIES> parseEntities{};
+        ParseEntitiesRing parseEntities{};
         std::array<CEntity, MAX_GENTITIES> currentEntities{};
+        EntitySet activeEntities{};  // Numbers of the valid currentEntities
+        EntityGrid entityGrid{};  // Valid currentEntities by their origin at serverTime
 
         // Snapshots
         int32_t clientNum = 0;
-        Snapshot curSnap{};
         std::array<Snapshot, PACKET_BACKUP> snapshots{};
+        size_t curSnapIndex = 0;  // The last valid snapshot in snapshots
         int32_t parseEntitiesNum = 0;  // In the current snapshot
         int32_t serverTime = 0;
 
@@ -4,6 +4,7 @@
 #include <string>
 #include <string_view>
 #include <map>
+#include <memory_resource>
 #include <vector>
 
 #include "CommandParser.h"
@@ -12,7 +13,7 @@ namespace JKA {
     class CommandExecutor {
     public:
         using Command = CommandParser::Command;
-        using Arguments = std::vector<CommandParser::Argument>;
+        using Arguments = std::pmr::vector<CommandParser::Argument>;
         using Callback = std::function<void(const Command & command)>;
 
         CommandExecutor() = default;
@@ -22,7 +23,9 @@ namespace JKA {
         CommandExecutor & operator=(CommandExecutor &&) noexcept = default;
         ~CommandExecutor() = default;
 
-        Command parseCommandString(std::string_view commandString);
+        // The command is allocated from resource
+        Command parseCommandString(std::string_view commandString,
+                                   std::pmr::memory_resource *resource = std::pmr::get_default_resource());
         void addCommand(std::string_view command, const Callback & callback);
 
         template<typename ThisType>
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory_resource>
 #include <string>
 #include <string_view>
 #include <sstream>
@@ -26,17 +27,23 @@ namespace JKA::CommandParser
     // and follows the std::from_chars()/std::strtof() rules;
     // In general it should be safe to assume that an argument with
     // isX() == true would be treated as getX() value in original JKA engine as well
+    // The strings are allocated from alloc's memory resource, so an Argument
+    // inside a std::pmr container is allocated from the container's.
     class Argument {
     public:
+        using allocator_type = std::pmr::polymorphic_allocator<char>;
+
         Argument();
-        Argument(std::string_view string);
+        Argument(std::string_view string, const allocator_type & alloc = {});
         Argument(const Argument &) = default;
+        Argument(const Argument & other, const allocator_type & alloc);
         Argument(Argument &&) = default;
+        Argument(Argument && other, const allocator_type & alloc);
         Argument & operator=(const Argument &) = default;
         Argument & operator=(Argument &&) = default;
         ~Argument() = default;
 
-        const std::string & getStr() const;
+        const std::pmr::string & getStr() const;
         int64_t getInt64() const;
         int32_t getInt32() const;
         float getFloat() const;
@@ -75,8 +82,8 @@ namespace JKA::CommandParser
         void setBool(bool val);
 
         TypeType type = 0;
-        std::string data = "";
-        std::string dataLower = "";
+        std::pmr::string data;
+        std::pmr::string dataLower;
         int64_t dataInt = 0;
         float dataFloat = 0.0f;
         bool dataBool = false;
@@ -100,7 +107,7 @@ namespace JKA::CommandParser
         if (begin != end) {
             ss << begin++->getStr();
             for (auto it = begin; it != end; ++it) {
-                auto itStr = it->getStr();
+                const auto & itStr = it->getStr();
                 ss << ' ';
                 if (escape && itStr.find(' ') != itStr.npos) {
                     ss << '"' << itStr << '"';
@@ -112,9 +119,37 @@ namespace JKA::CommandParser
         return ss.str();
     }
 
+    // Allocator-aware, like Argument
     struct Command {
-        std::string name = "";
-        std::vector<Argument> args{};
+        using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+        Command() = default;
+        explicit Command(const allocator_type & alloc) :
+            name(alloc),
+            args(alloc)
+        {
+        }
+
+        Command(const Command &) = default;
+        Command(const Command & other, const allocator_type & alloc) :
+            name(other.name, alloc),
+            args(other.args, alloc)
+        {
+        }
+
+        Command(Command &&) = default;
+        Command(Command && other, const allocator_type & alloc) :
+            name(std::move(other.name), alloc),
+            args(std::move(other.args), alloc)
+        {
+        }
+
+        Command & operator=(const Command &) = default;
+        Command & operator=(Command &&) = default;
+        ~Command() = default;
+
+        std::pmr::string name{};
+        std::pmr::vector<Argument> args{};
 
         std::string concat(size_t startIdx = 0, size_t endIdx = std::string::npos) const
         {
@@ -130,5 +165,7 @@ namespace JKA::CommandParser
         }
     };
 
-    Command parseCommand(std::string_view cmd, std::string_view sepChars = " \r\n");
+    // The command is allocated from resource
+    Command parseCommand(std::string_view cmd, std::string_view sepChars = " \r\n",
+                         std::pmr::memory_resource *resource = std::pmr::get_default_resource());
 }
@@ -0,0 +1,95 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "JKAInfo.h"
+#include "jka/JKAConstants.h"
+#include "jka/JKAEnums.h"
+
+namespace JKA {
+    // Typed views of the configstrings most consumers decode over and over.
+    // ClientGameState::setConfigString() refreshes the view of the index it has
+    // set, and nothing else, so reading them is a plain array read.
+    // Configstrings the parser is not interested in (ParserInterests) stay empty.
+    struct ConfigStringViews {
+        // Sized once, indexed like arrays
+        using Strings = std::pmr::vector<std::pmr::string>;
+
+        // CS_PLAYERS, column by column
+        struct Players {
+            explicit Players(std::pmr::memory_resource *resource);
+
+            std::array<bool, MAX_CLIENTS> present{};
+            Strings names;
+            Strings cleanNames;  // Without colour codes
+            std::array<team_t, MAX_CLIENTS> teams{};
+            Strings models;
+        };
+
+        // CS_SERVERINFO
+        struct ServerInfo {
+            explicit ServerInfo(std::pmr::memory_resource *resource) :
+                hostname(resource),
+                mapname(resource)
+            {
+            }
+
+            std::pmr::string hostname;
+            std::pmr::string mapname;
+            int32_t gametype = 0;
+            int32_t maxClients = 0;
+            int32_t timelimit = 0;
+            int32_t fraglimit = 0;
+            int32_t capturelimit = 0;
+            bool needPass = false;
+        };
+
+        // CS_SYSTEMINFO
+        struct SystemInfo {
+            explicit SystemInfo(std::pmr::memory_resource *resource) :
+                game(resource)
+            {
+            }
+
+            int32_t serverId = 0;
+            bool pure = false;
+            bool cheats = false;
+            std::pmr::string game;  // fs_game
+        };
+
+        ConfigStringViews() :
+            ConfigStringViews(std::pmr::get_default_resource())
+        {
+        }
+
+        // The strings are allocated from resource, like ClientGameState's configstrings
+        explicit ConfigStringViews(std::pmr::memory_resource *resource);
+        ConfigStringViews(const ConfigStringViews &) = default;
+        ConfigStringViews(ConfigStringViews &&) noexcept = default;
+        ConfigStringViews & operator=(const ConfigStringViews &) = default;
+        ConfigStringViews & operator=(ConfigStringViews &&) noexcept = default;
+        ~ConfigStringViews() = default;
+
+        // info: value parsed already, if it is
+        void update(size_t index, std::string_view value, const JKAInfo *info = nullptr);
+        void clear();
+
+        Players players;
+        ServerInfo serverInfo;
+        SystemInfo systemInfo;
+        Strings models;     // CS_MODELS + i
+        Strings sounds;     // CS_SOUNDS + i
+        Strings locations;  // CS_LOCATIONS + i
+
+        // Change along with the views
+        uint64_t playersVersion = 0;
+        uint64_t serverInfoVersion = 0;
+        uint64_t systemInfoVersion = 0;
+        uint64_t tablesVersion = 0;  // models, sounds, locations
+    };
+}
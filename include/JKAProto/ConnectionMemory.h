@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+
+namespace JKA {
+    // Memory of a single connection's state: a pool over a monotonic arena,
+    // neither of them synchronized, so a connection handled by one thread
+    // never contends with the others for the global allocator.
+    // Everything allocated from resource() must be destroyed (or cleared
+    // and shrunk) before release().
+    class ConnectionMemory {
+    public:
+        static constexpr size_t DEFAULT_INITIAL_SIZE = 64 * 1024;
+
+        explicit ConnectionMemory(size_t initialSize = DEFAULT_INITIAL_SIZE,
+                                  std::pmr::memory_resource *upstream = std::pmr::get_default_resource()) :
+            arena(initialSize, upstream),
+            pool(&arena)
+        {
+        }
+
+        ConnectionMemory(const ConnectionMemory &) = delete;
+        ConnectionMemory(ConnectionMemory &&) = delete;
+        ConnectionMemory & operator=(const ConnectionMemory &) = delete;
+        ConnectionMemory & operator=(ConnectionMemory &&) = delete;
+        ~ConnectionMemory() = default;
+
+        std::pmr::memory_resource *resource() noexcept
+        {
+            return &pool;
+        }
+
+        // Gives all of the memory back to the upstream resource at once
+        void release() noexcept
+        {
+            pool.release();
+            arena.release();
+        }
+
+    private:
+        std::pmr::monotonic_buffer_resource arena;
+        std::pmr::unsynchronized_pool_resource pool;
+    };
+}
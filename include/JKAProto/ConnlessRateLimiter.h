@@ -0,0 +1,120 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ServerAddress.h"
+#include "SharedDefs.h"
+#include "jka/JKAEnums.h"
+#include "packets/ConnlessPacketView.h"
+
+namespace JKA {
+    // Token buckets for connless requests, per source address and per packet type,
+    // plus a total bucket per packet type (JKA only has a single leaky bucket,
+    // for getstatus).
+    // The per source buckets live in a fixed size table indexed by a seeded hash
+    // of (address, type), so spoofed addresses cost no memory. Each request maps
+    // to a bucket in each of ROWS rows and is allowed if the fullest of them has
+    // a token left, like a count-min sketch: colliding sources share a bucket
+    // in one row, but rarely in all of them.
+    class ConnlessRateLimiter {
+    public:
+        static constexpr size_t ROWS = 2;
+        // Every ConnlessType, then the packets that could not be parsed
+        static constexpr size_t TYPES = CLS__MAX + 1;
+
+        struct Budget {
+            uint32_t rate = 0;   // Tokens per second, 0 for unlimited
+            uint32_t burst = 0;  // Bucket size
+
+            constexpr bool unlimited() const noexcept
+            {
+                return rate == 0;
+            }
+        };
+
+        using Budgets = std::array<Budget, TYPES>;
+
+        struct Options {
+            size_t slots = 1 << 14;  // Per row, rounded up to a power of 2
+            Budgets perSource = defaultPerSource();
+            Budgets total = defaultTotal();
+            uint64_t seed = 0;       // Should be random, so that collisions can't be aimed at
+        };
+
+        struct Stats {
+            std::array<uint64_t, TYPES> allowed{};
+            std::array<uint64_t, TYPES> droppedBySource{};
+            std::array<uint64_t, TYPES> droppedByTotal{};
+
+            uint64_t dropped() const noexcept;
+        };
+
+        static constexpr Budgets defaultPerSource() noexcept
+        {
+            Budgets budgets{};
+            for (auto & budget : budgets) {
+                budget = Budget{ 10, 20 };
+            }
+            budgets[CLS_GETINFO] = Budget{ 2, 10 };
+            budgets[CLS_GETSTATUS] = Budget{ 2, 10 };
+            budgets[CLS_GETCHALLENGE] = Budget{ 2, 10 };
+            budgets[CLS_CONNECT] = Budget{ 2, 5 };
+            budgets[CLS_RCON] = Budget{ 1, 5 };
+            budgets[CLS__BAD] = Budget{ 1, 5 };
+            return budgets;
+        }
+
+        static constexpr Budgets defaultTotal() noexcept
+        {
+            Budgets budgets{};
+            budgets[CLS_GETINFO] = Budget{ 1000, 2000 };
+            budgets[CLS_GETSTATUS] = Budget{ 100, 200 };  // Largest replies
+            budgets[CLS_RCON] = Budget{ 50, 100 };
+            return budgets;
+        }
+
+        explicit ConnlessRateLimiter(const Options & options);
+        ConnlessRateLimiter(const ConnlessRateLimiter &) = default;
+        ConnlessRateLimiter(ConnlessRateLimiter &&) noexcept = default;
+        ConnlessRateLimiter & operator=(const ConnlessRateLimiter &) = default;
+        ConnlessRateLimiter & operator=(ConnlessRateLimiter &&) noexcept = default;
+        ~ConnlessRateLimiter() = default;
+
+        // Takes a token from the buckets of the request if it is allowed.
+        // type is CLS__BAD for unparsable packets.
+        bool allow(const ServerAddress & from, ConnlessType type, TimePoint now) noexcept;
+
+        bool allow(const ServerAddress & from, const Packets::ConnlessPacketView & packet, TimePoint now) noexcept
+        {
+            return allow(from, Packets::getType(packet), now);
+        }
+
+        const Stats & getStats() const & noexcept
+        {
+            return stats;
+        }
+
+    private:
+        // Zero is a full bucket
+        struct Bucket {
+            uint32_t used = 0;    // Milli-tokens taken
+            uint32_t lastMs = 0;  // Of the last refill, wraps around
+        };
+
+        static constexpr uint32_t TOKEN = 1000;
+
+        static void refill(Bucket & bucket, const Budget & budget, uint32_t nowMs) noexcept;
+        static uint32_t capacity(const Budget & budget) noexcept;
+
+        size_t mask;
+        uint64_t seed;
+        Budgets perSource;
+        Budgets total;
+
+        std::vector<Bucket> buckets;  // ROWS rows of mask + 1 slots
+        std::array<Bucket, TYPES> totalBuckets{};
+        Stats stats{};
+    };
+}
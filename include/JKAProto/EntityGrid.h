@@ -0,0 +1,213 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "Geometry.h"
+#include "SharedDefs.h"
+#include "utility/Span.h"
+#include "jka/JKAConstants.h"
+#include "jka/JKAStructs.h"
+
+namespace JKA {
+    // Uniform grid over the XY plane of the world, keyed on entity origins.
+    // JKA maps are mostly flat, so Z is not bucketed, only checked by the queries.
+    // Entities outside of the world bounds are clamped into the border cells.
+    class EntityGrid {
+    public:
+        static constexpr float CELL_SIZE = 1024.0f;
+        static constexpr int32_t CELLS_PER_AXIS = (MAX_WORLD_COORD - MIN_WORLD_COORD) / static_cast<int32_t>(CELL_SIZE);
+        static constexpr int32_t CELLS_COUNT = CELLS_PER_AXIS * CELLS_PER_AXIS;
+
+        EntityGrid() noexcept;
+        EntityGrid(const EntityGrid &) = default;
+        EntityGrid(EntityGrid &&) noexcept = default;
+        EntityGrid & operator=(const EntityGrid &) = default;
+        EntityGrid & operator=(EntityGrid &&) noexcept = default;
+        ~EntityGrid() = default;
+
+        void clear() noexcept;
+
+        // Inserts the entity or moves it to the new origin
+        void update(int32_t entityNum, const vec3_t & origin) noexcept;
+        void remove(int32_t entityNum) noexcept;
+
+        bool contains(int32_t entityNum) const noexcept
+        {
+            return entityNum >= 0 && entityNum < MAX_GENTITIES && cellOf[entityNum] >= 0;
+        }
+
+        size_t size() const noexcept
+        {
+            return count;
+        }
+
+        // The origin the entity was indexed with
+        Vec3 origin(int32_t entityNum) const noexcept
+        {
+            return Vec3(posX[entityNum], posY[entityNum], posZ[entityNum]);
+        }
+
+        // f(int32_t entityNum) for every entity inside of [mins, maxs]
+        template<typename F>
+        void forEachInBox(const Vec3 & mins, const Vec3 & maxs, F && f) const
+        {
+            forEachCell(mins[0], mins[1], maxs[0], maxs[1], [&](int32_t entityNum) {
+                if (posX[entityNum] >= mins[0] && posX[entityNum] <= maxs[0]
+                    && posY[entityNum] >= mins[1] && posY[entityNum] <= maxs[1]
+                    && posZ[entityNum] >= mins[2] && posZ[entityNum] <= maxs[2]) {
+                    f(entityNum);
+                }
+            });
+        }
+
+        // f(int32_t entityNum) for every entity within radius of center
+        template<typename F>
+        void forEachInRadius(const Vec3 & center, float radius, F && f) const
+        {
+            float radiusSq = radius * radius;
+            forEachCell(center[0] - radius, center[1] - radius, center[0] + radius, center[1] + radius,
+                        [&](int32_t entityNum) {
+                if (distanceSq(entityNum, center) <= radiusSq) {
+                    f(entityNum);
+                }
+            });
+        }
+
+        // Up to out.size() entities accepted by pred(int32_t entityNum),
+        // closest first. Returns the number of entities written.
+        template<typename Pred>
+        size_t nearest(const Vec3 & center, Utility::Span<int32_t> out, Pred && pred) const
+        {
+            using Candidate = std::pair<float, int32_t>;  // Squared distance, entity number
+
+            size_t k = std::min(out.size(), count);
+            if (k == 0) {
+                return 0;
+            }
+
+            // Max-heap of the k best candidates so far
+            std::array<Candidate, MAX_GENTITIES> heap;
+            size_t heapSize = 0;
+
+            auto consider = [&](int32_t entityNum) {
+                if (!pred(entityNum)) {
+                    return;
+                }
+
+                float distSq = distanceSq(entityNum, center);
+                if (heapSize < k) {
+                    heap[heapSize++] = { distSq, entityNum };
+                    std::push_heap(heap.begin(), heap.begin() + heapSize);
+                } else if (distSq < heap[0].first) {
+                    std::pop_heap(heap.begin(), heap.begin() + heapSize);
+                    heap[heapSize - 1] = { distSq, entityNum };
+                    std::push_heap(heap.begin(), heap.begin() + heapSize);
+                }
+            };
+
+            // Walk square rings of cells around the center cell until nothing
+            // outside of the visited area can be closer than the k-th candidate
+            int32_t cx = cellCoord(center[0]);
+            int32_t cy = cellCoord(center[1]);
+            for (int32_t ring = 0; ring < CELLS_PER_AXIS; ring++) {
+                int32_t minX = cx - ring, maxX = cx + ring;
+                int32_t minY = cy - ring, maxY = cy + ring;
+
+                for (int32_t y = std::max(minY, 0); y <= std::min(maxY, CELLS_PER_AXIS - 1); y++) {
+                    bool edgeRow = (y == minY || y == maxY);
+                    int32_t step = edgeRow ? 1 : (maxX - minX);
+                    for (int32_t x = minX; x <= maxX; x += std::max(step, 1)) {
+                        if (x >= 0 && x < CELLS_PER_AXIS) {
+                            forEachInCell(y * CELLS_PER_AXIS + x, consider);
+                        }
+                    }
+                }
+
+                bool coversGrid = minX <= 0 && minY <= 0
+                    && maxX >= CELLS_PER_AXIS - 1 && maxY >= CELLS_PER_AXIS - 1;
+                if (coversGrid) {
+                    break;
+                }
+
+                if (heapSize == k) {
+                    float bound = ringBound(center, minX, minY, maxX, maxY);
+                    if (heap[0].first <= bound * bound) {
+                        break;
+                    }
+                }
+            }
+
+            std::sort_heap(heap.begin(), heap.begin() + heapSize);
+            for (size_t i = 0; i < heapSize; i++) {
+                out[i] = heap[i].second;
+            }
+
+            return heapSize;
+        }
+
+        size_t nearest(const Vec3 & center, Utility::Span<int32_t> out) const
+        {
+            return nearest(center, out, [](int32_t) { return true; });
+        }
+
+    private:
+        static constexpr int16_t NONE = -1;
+
+        static int32_t cellCoord(float coord) noexcept;
+        static float cellMin(int32_t cell) noexcept;
+
+        float distanceSq(int32_t entityNum, const Vec3 & center) const noexcept
+        {
+            float dx = posX[entityNum] - center[0];
+            float dy = posY[entityNum] - center[1];
+            float dz = posZ[entityNum] - center[2];
+            return dx * dx + dy * dy + dz * dz;
+        }
+
+        // Distance from center to the closest point outside of the
+        // [minX, maxX]x[minY, maxY] cells that is still inside of the grid
+        float ringBound(const Vec3 & center, int32_t minX, int32_t minY, int32_t maxX, int32_t maxY) const noexcept;
+
+        template<typename F>
+        void forEachInCell(int32_t cell, F && f) const
+        {
+            for (int16_t entityNum = heads[cell]; entityNum != NONE; entityNum = next[entityNum]) {
+                f(entityNum);
+            }
+        }
+
+        template<typename F>
+        void forEachCell(float minX, float minY, float maxX, float maxY, F && f) const
+        {
+            if (count == 0 || minX > maxX || minY > maxY) {
+                return;
+            }
+
+            int32_t x0 = cellCoord(minX), x1 = cellCoord(maxX);
+            int32_t y0 = cellCoord(minY), y1 = cellCoord(maxY);
+            for (int32_t y = y0; y <= y1; y++) {
+                for (int32_t x = x0; x <= x1; x++) {
+                    forEachInCell(y * CELLS_PER_AXIS + x, f);
+                }
+            }
+        }
+
+        void link(int32_t entityNum, int32_t cell) noexcept;
+        void unlink(int32_t entityNum) noexcept;
+
+        size_t count = 0;
+
+        // Intrusive per-cell lists of entity numbers
+        std::array<int16_t, CELLS_COUNT> heads{};
+        std::array<int16_t, MAX_GENTITIES> next{};
+        std::array<int16_t, MAX_GENTITIES> prev{};
+        std::array<int32_t, MAX_GENTITIES> cellOf{};  // -1 if not indexed
+
+        std::array<float, MAX_GENTITIES> posX{};
+        std::array<float, MAX_GENTITIES> posY{};
+        std::array<float, MAX_GENTITIES> posZ{};
+    };
+}
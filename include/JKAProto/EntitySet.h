@@ -0,0 +1,97 @@
+#pragma once
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+#include "utility/Span.h"
+#include "jka/JKAConstants.h"
+
+namespace JKA {
+    // A set of entity numbers with O(1) insertion, removal and lookup,
+    // iterable as a dense array. The order of the entities is unspecified:
+    // removal moves the last entity into the freed position.
+    class EntitySet {
+    public:
+        EntitySet() noexcept = default;
+        EntitySet(const EntitySet &) = default;
+        EntitySet(EntitySet &&) noexcept = default;
+        EntitySet & operator=(const EntitySet &) = default;
+        EntitySet & operator=(EntitySet &&) noexcept = default;
+        ~EntitySet() = default;
+
+        void insert(int32_t entityNum) noexcept
+        {
+            if (entityNum < 0 || entityNum >= MAX_GENTITIES || mask.test(entityNum)) {
+                return;
+            }
+
+            mask.set(entityNum);
+            positions[entityNum] = static_cast<uint16_t>(count);
+            dense[count++] = static_cast<uint16_t>(entityNum);
+        }
+
+        void erase(int32_t entityNum) noexcept
+        {
+            if (!contains(entityNum)) {
+                return;
+            }
+
+            // Swap-remove
+            uint16_t pos = positions[entityNum];
+            uint16_t last = dense[--count];
+            dense[pos] = last;
+            positions[last] = pos;
+
+            mask.reset(entityNum);
+        }
+
+        void clear() noexcept
+        {
+            mask.reset();
+            count = 0;
+        }
+
+        bool contains(int32_t entityNum) const noexcept
+        {
+            return entityNum >= 0 && entityNum < MAX_GENTITIES && mask.test(entityNum);
+        }
+
+        size_t size() const noexcept
+        {
+            return count;
+        }
+
+        bool empty() const noexcept
+        {
+            return count == 0;
+        }
+
+        // Entity numbers, unordered
+        Utility::Span<const uint16_t> entities() const & noexcept
+        {
+            return Utility::Span<const uint16_t>(dense.data(), count);
+        }
+
+        const uint16_t *begin() const noexcept
+        {
+            return dense.data();
+        }
+
+        const uint16_t *end() const noexcept
+        {
+            return dense.data() + count;
+        }
+
+        const std::bitset<MAX_GENTITIES> & bits() const & noexcept
+        {
+            return mask;
+        }
+
+    private:
+        std::bitset<MAX_GENTITIES> mask{};
+        size_t count = 0;
+        std::array<uint16_t, MAX_GENTITIES> dense{};
+        std::array<uint16_t, MAX_GENTITIES> positions{};  // Entity number -> index in dense
+    };
+}
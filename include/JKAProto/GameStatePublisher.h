@@ -0,0 +1,174 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "ClientGameState.h"
+#include "Snapshot.h"
+#include "jka/JKAConstants.h"
+#include "jka/JKAStructs.h"
+#include "utility/Span.h"
+#include "utility/SpscQueue.h"
+
+namespace JKA {
+    // A read-only copy of the ClientGameState as of one parsed snapshot
+    struct PublishedGameState {
+        using ConfigStrings = std::map<size_t, std::string, std::less<>>;
+
+        int32_t serverTime = 0;
+        int32_t clientNum = 0;
+        Snapshot snapshot{};
+
+        // States of the valid currentEntities, unordered
+        std::array<entityState_t, MAX_GENTITIES> entities{};
+        size_t numEntities = 0;
+
+        // Shared between the published states until a configstring changes
+        std::shared_ptr<const ConfigStrings> configStrings{};
+
+        Utility::Span<const entityState_t> activeEntities() const & noexcept
+        {
+            return Utility::Span<const entityState_t>(entities.data(), numEntities);
+        }
+
+        std::string_view getConfigString(size_t index) const &
+        {
+            if (configStrings == nullptr) {
+                return "";
+            }
+
+            auto it = configStrings->find(index);
+            if (it != configStrings->end()) {
+                return it->second;
+            } else {
+                return "";
+            }
+        }
+    };
+
+    // Publishes a copy of the game state after every parsed snapshot
+    // (see ServerPacketParser::setPublisher) for other threads to read.
+    // The parser writes into a slot no reader holds and never waits:
+    // if every slot is held, that snapshot is not published.
+    // Readers hold a slot through a View for as long as they need
+    // a consistent state, they should not keep it for too long.
+    class GameStatePublisher {
+    public:
+        static constexpr size_t SLOTS = 4;
+
+        // Holds the published state it points to
+        class View {
+        public:
+            View() noexcept = default;
+            View(const View &) = delete;
+            View(View && other) noexcept : readers(other.readers), state(other.state)
+            {
+                other.readers = nullptr;
+                other.state = nullptr;
+            }
+
+            View & operator=(const View &) = delete;
+            View & operator=(View && other) noexcept
+            {
+                if (this != &other) {
+                    release();
+                    readers = other.readers;
+                    state = other.state;
+                    other.readers = nullptr;
+                    other.state = nullptr;
+                }
+                return *this;
+            }
+
+            ~View()
+            {
+                release();
+            }
+
+            explicit operator bool() const noexcept
+            {
+                return state != nullptr;
+            }
+
+            const PublishedGameState & operator*() const & noexcept
+            {
+                return *state;
+            }
+
+            const PublishedGameState *operator->() const & noexcept
+            {
+                return state;
+            }
+
+            void release() noexcept
+            {
+                if (readers != nullptr) {
+                    readers->fetch_sub(1, std::memory_order_release);
+                    readers = nullptr;
+                    state = nullptr;
+                }
+            }
+
+        private:
+            friend class GameStatePublisher;
+
+            View(std::atomic<uint32_t> *readers_, const PublishedGameState *state_) noexcept :
+                readers(readers_),
+                state(state_)
+            {
+            }
+
+            std::atomic<uint32_t> *readers = nullptr;
+            const PublishedGameState *state = nullptr;
+        };
+
+        GameStatePublisher();
+        GameStatePublisher(const GameStatePublisher &) = delete;
+        GameStatePublisher(GameStatePublisher &&) = delete;
+        GameStatePublisher & operator=(const GameStatePublisher &) = delete;
+        GameStatePublisher & operator=(GameStatePublisher &&) = delete;
+        ~GameStatePublisher() = default;
+
+        // Writer (parser) thread only. false if the state was not published.
+        bool publish(const ClientGameState & gameState);
+
+        // Any thread. The latest published state, empty if there is none yet.
+        View acquire() const noexcept;
+
+        uint64_t publishedCount() const noexcept
+        {
+            return published.load(std::memory_order_relaxed);
+        }
+
+        uint64_t skippedCount() const noexcept
+        {
+            return skipped.load(std::memory_order_relaxed);
+        }
+
+    private:
+        // Set in Slot::readers while the writer fills the slot
+        static constexpr uint32_t WRITING = 1u << 31;
+
+        struct Slot {
+            alignas(Utility::CACHE_LINE_SIZE) std::atomic<uint32_t> readers{};
+            PublishedGameState state{};
+        };
+
+        void copyState(PublishedGameState & state, const ClientGameState & gameState);
+
+        std::unique_ptr<Slot[]> slots;
+        std::atomic<int32_t> latest{ -1 };
+
+        // Writer only: the configstrings as of configStringsVersion
+        std::shared_ptr<const PublishedGameState::ConfigStrings> configStrings{};
+        uint64_t configStringsVersion = 0;
+
+        std::atomic<uint64_t> published{};
+        std::atomic<uint64_t> skipped{};
+    };
+}
@@ -1,25 +1,35 @@
 #pragma once
 
+#include <cstdint>
+#include <map>
+#include <memory_resource>
 #include <string>
 #include <string_view>
-#include <map>
 
 namespace JKA {
     // NOTE: All infostring keys are lowercase
-    class JKAInfo : public std::map<std::string, std::string, std::less<>> {
+    // The keys and values are allocated from the map's memory resource, so a
+    // JKAInfo inside a std::pmr container is allocated from the container's.
+    class JKAInfo : public std::pmr::map<std::pmr::string, std::pmr::string, std::less<>> {
     public:
-        using MapType = std::map<std::string, std::string, std::less<>>;
+        using MapType = std::pmr::map<std::pmr::string, std::pmr::string, std::less<>>;
+        using allocator_type = MapType::allocator_type;
 
         JKAInfo() = default;
+        explicit JKAInfo(const allocator_type & alloc);
         JKAInfo(const JKAInfo &) = default;
+        JKAInfo(const JKAInfo & other, const allocator_type & alloc);
         JKAInfo(JKAInfo &&) noexcept = default;
-        explicit JKAInfo(std::string_view info);
+        JKAInfo(JKAInfo && other, const allocator_type & alloc);
+        explicit JKAInfo(std::string_view info, const allocator_type & alloc = {});
         JKAInfo & operator=(const JKAInfo &) = default;
         JKAInfo & operator=(JKAInfo &&) = default;
 
         ~JKAInfo() = default;
 
-        static JKAInfo fromInfostring(std::string_view info);
+        static JKAInfo fromInfostring(std::string_view info, const allocator_type & alloc = {});
+        // Replaces the fields with info's, keeping the memory resource
+        void assignInfostring(std::string_view info);
         std::string toInfostring() const;
 
         std::string_view getField(std::string_view fieldName) const;
@@ -0,0 +1,129 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ChallengeCookies.h"
+#include "ServerAddress.h"
+#include "SharedDefs.h"
+#include "packets/ConnlessPacketView.h"
+#include "utility/Span.h"
+
+namespace JKA {
+    // A master server: a heartbeat is answered with a getinfo, and the
+    // infoResponse with the right challenge registers the server until it
+    // expires. getservers is answered with the servers matching its filter,
+    // split into getserversResponse datagrams of at most Options::maxDatagram
+    // bytes, the last one ending with EOT. The datagrams are cached per filter
+    // until the list changes.
+    // Does no I/O itself, datagrams go out through a Transport.
+    class MasterServer {
+    public:
+        using Duration = std::chrono::seconds;
+
+        class Transport {
+        public:
+            virtual ~Transport() = default;
+            virtual void send(const ServerAddress & to, Utility::Span<const char> datagram) = 0;
+        };
+
+        struct Options {
+            Duration timeout{ 15 * 60 };  // Since the last infoResponse
+            size_t maxServers = 1 << 16;
+            size_t maxDatagram = 1400;
+        };
+
+        // What getservers asks for: "<protocol> [empty] [full]"
+        struct Filter {
+            enum : uint8_t {
+                EMPTY = 1 << 0,  // Also the servers without players
+                FULL = 1 << 1,   // Also the full servers
+            };
+
+            int32_t protocol = PROTOCOL_VERSION;
+            uint8_t flags = 0;
+
+            static Filter parse(std::string_view getserversData) noexcept;
+
+            uint64_t key() const noexcept
+            {
+                return (static_cast<uint64_t>(static_cast<uint32_t>(protocol)) << 8) | flags;
+            }
+        };
+
+        struct Stats {
+            uint64_t heartbeats = 0;
+            uint64_t registered = 0;    // Servers added
+            uint64_t expired = 0;
+            uint64_t rejected = 0;      // Wrong challenge, or the table is full
+            uint64_t queries = 0;       // getservers
+            uint64_t cacheMisses = 0;   // Of the queries
+            uint64_t datagramsSent = 0;
+        };
+
+        MasterServer(Transport & transport_, const ChallengeCookies & cookies_, Options options_);
+        MasterServer(const MasterServer &) = delete;
+        MasterServer(MasterServer &&) = delete;
+        MasterServer & operator=(const MasterServer &) = delete;
+        MasterServer & operator=(MasterServer &&) = delete;
+        ~MasterServer() = default;
+
+        // heartbeat, infoResponse and getservers, the rest is ignored
+        void handlePacket(const ServerAddress & from, const Packets::ConnlessPacketView & packet, TimePoint now);
+        // Removes the expired servers. Call it every few seconds.
+        void poll(TimePoint now);
+
+        // The getserversResponse datagrams for filter
+        const std::vector<std::vector<char>> & responses(const Filter & filter);
+
+        size_t size() const noexcept
+        {
+            return count;
+        }
+
+        const Stats & getStats() const & noexcept
+        {
+            return stats;
+        }
+
+    private:
+        // 16 bytes per server
+        struct Entry {
+            uint64_t stored = EMPTY;  // ServerAddress::key() + 1
+            uint32_t expiresAt = 0;   // Seconds since the epoch
+            int16_t protocol = 0;
+            uint8_t flags = 0;        // Filter flags this server needs
+        };
+
+        struct CachedResponses {
+            uint64_t generation = 0;
+            std::vector<std::vector<char>> datagrams{};
+        };
+
+        static constexpr uint64_t EMPTY = 0;
+        static constexpr size_t MIN_SLOTS = 64;
+        static constexpr size_t MAX_CACHED_FILTERS = 64;
+
+        void onInfoResponse(const ServerAddress & from, std::string_view data, TimePoint now);
+
+        size_t slotOf(uint64_t stored) const noexcept;
+        Entry *find(uint64_t stored) noexcept;
+        Entry *insert(uint64_t stored);
+        void erase(size_t idx) noexcept;
+        void rehash(size_t slotCount);
+
+        void build(const Filter & filter, std::vector<std::vector<char>> & datagrams) const;
+
+        Transport & transport;
+        const ChallengeCookies & cookies;
+        Options options;
+
+        std::vector<Entry> slots{};  // Linear probing, size is a power of two
+        size_t count = 0;
+        uint64_t generation = 1;     // Changes along with any server a filter could see
+        std::unordered_map<uint64_t, CachedResponses> cache{};
+        Stats stats{};
+    };
+}
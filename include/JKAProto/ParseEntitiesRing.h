@@ -0,0 +1,100 @@
+#pragma once
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "jka/JKAConstants.h"
+#include "jka/JKAStructs.h"
+
+namespace JKA {
+    // The circular buffer of the entities of the last snapshots
+    // (clSnapshot_t::parseEntitiesNum/numEntities index into it).
+    // Slots hold reference-counted handles to pooled entityState_t's,
+    // so an entity that is unchanged from the delta frame shares
+    // the state instead of copying it.
+    class ParseEntitiesRing {
+    public:
+        static constexpr size_t SIZE = MAX_PARSE_ENTITIES;
+
+        ParseEntitiesRing() noexcept
+        {
+            reset();
+        }
+
+        ParseEntitiesRing(const ParseEntitiesRing &) = default;
+        ParseEntitiesRing(ParseEntitiesRing &&) noexcept = default;
+        ParseEntitiesRing & operator=(const ParseEntitiesRing &) = default;
+        ParseEntitiesRing & operator=(ParseEntitiesRing &&) noexcept = default;
+        ~ParseEntitiesRing() = default;
+
+        // All slots refer to a single zeroed state
+        void reset() noexcept
+        {
+            pool[0] = {};
+            slots.fill(0);
+            refs.fill(0);
+            refs[0] = static_cast<uint16_t>(SIZE);
+
+            freeCount = 0;
+            for (size_t handle = POOL_SIZE - 1; handle > 1; handle--) {
+                freeHandles[freeCount++] = static_cast<uint16_t>(handle);
+            }
+            scratch = 1;
+        }
+
+        const entityState_t & operator[](size_t parseNum) const & noexcept
+        {
+            return pool[slots[parseNum % SIZE]];
+        }
+
+        // Makes parseNum refer to the state of fromParseNum
+        void share(size_t parseNum, size_t fromParseNum) noexcept
+        {
+            uint16_t handle = slots[fromParseNum % SIZE];
+            refs[handle]++;
+            assign(parseNum, handle);
+        }
+
+        // A spare state to decode a new entity into before commit()
+        entityState_t & scratchState() & noexcept
+        {
+            return pool[scratch];
+        }
+
+        // Stores the scratch state into parseNum
+        void commit(size_t parseNum) noexcept
+        {
+            refs[scratch] = 1;
+            assign(parseNum, scratch);
+
+            assert(freeCount > 0);
+            scratch = freeHandles[--freeCount];
+        }
+
+    private:
+        // Every slot may hold a distinct state, plus the scratch one
+        static constexpr size_t POOL_SIZE = SIZE + 1;
+
+        void assign(size_t parseNum, uint16_t handle) noexcept
+        {
+            uint16_t & slot = slots[parseNum % SIZE];
+            release(slot);
+            slot = handle;
+        }
+
+        void release(uint16_t handle) noexcept
+        {
+            if (--refs[handle] == 0) {
+                freeHandles[freeCount++] = handle;
+            }
+        }
+
+        std::array<uint16_t, SIZE> slots{};
+        std::array<entityState_t, POOL_SIZE> pool{};
+        std::array<uint16_t, POOL_SIZE> refs{};
+        std::array<uint16_t, POOL_SIZE> freeHandles{};
+        size_t freeCount = 0;
+        uint16_t scratch = 0;
+    };
+}
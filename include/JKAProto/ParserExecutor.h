@@ -0,0 +1,160 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ClientConnection.h"
+#include "ClientEventsListener.h"
+#include "ClientGameState.h"
+#include "ConnectionMemory.h"
+#include "Huffman.h"
+#include "ReliableCommandsStore.h"
+#include "ServerPacketParser.h"
+#include "SharedDefs.h"
+#include "protocol/Netchan.h"
+#include "protocol/PacketEncoder.h"
+#include "protocol/RawPacket.h"
+#include "utility/SpscQueue.h"
+
+namespace JKA {
+    // Everything needed to follow one server connection.
+    // Not movable: the parser refers to the other members.
+    struct ObservedServer {
+        explicit ObservedServer(ClientEventsListener & listener);
+        ObservedServer(const ObservedServer &) = delete;
+        ObservedServer(ObservedServer &&) = delete;
+        ObservedServer & operator=(const ObservedServer &) = delete;
+        ObservedServer & operator=(ObservedServer &&) = delete;
+        ~ObservedServer() = default;
+
+        // Both connless and connfull packets from the server
+        void handlePacket(Protocol::RawPacket & packet, TimePoint arriveTime, Q3Huffman & huffman);
+
+        // Forgets the server and gives its memory back to the upstream resource.
+        // Must not be called while a packet of this server is being handled.
+        void reset();
+
+        // Destroyed last
+        ConnectionMemory memory{};
+
+        ClientEventsListener & listener;
+        ClientConnection connection{};
+        ReliableCommandsStore reliableCommands{};
+        std::unique_ptr<ClientGameState> gameState = std::make_unique<ClientGameState>(memory.resource());
+        Protocol::Netchan<Protocol::ServerPacketEncoder> netchan{};
+        ServerPacketParser parser;
+    };
+
+    // Runs many ObservedServers on a pool of worker threads.
+    // Every connection is pinned to one worker, which is the only
+    // thread touching its state, so parsing takes no locks.
+    // Packets are handed to the workers through SPSC queues: post(),
+    // addConnection(), removeConnection() and execute() must all be
+    // called from the same thread (usually the one reading the socket).
+    // Listener callbacks run on the worker threads.
+    class ParserExecutor {
+    public:
+        using ConnectionId = uint32_t;
+        // Runs on the connection's worker
+        using Task = std::function<void(ObservedServer &)>;
+
+        static constexpr size_t DEFAULT_QUEUE_CAPACITY = 4096;
+
+        // workerCount == 0 means one per hardware thread
+        explicit ParserExecutor(size_t workerCount = 0,
+                                size_t queueCapacity = DEFAULT_QUEUE_CAPACITY);
+        ParserExecutor(const ParserExecutor &) = delete;
+        ParserExecutor(ParserExecutor &&) = delete;
+        ParserExecutor & operator=(const ParserExecutor &) = delete;
+        ParserExecutor & operator=(ParserExecutor &&) = delete;
+        ~ParserExecutor();
+
+        void start();
+        // Processes whatever has already been posted, then joins the workers
+        void stop();
+
+        ConnectionId addConnection(std::unique_ptr<ObservedServer> server);
+        void removeConnection(ConnectionId id);
+
+        // false if the worker's queue is full, the packet is then dropped
+        bool post(ConnectionId id, Protocol::RawPacket packet, TimePoint arriveTime);
+        // E.g. to send a packet or read the game state of the connection
+        bool execute(ConnectionId id, Task task);
+
+        size_t workerCount() const noexcept
+        {
+            return workers.size();
+        }
+
+        size_t workerOf(ConnectionId id) const noexcept
+        {
+            return id % workers.size();
+        }
+
+        // For setting the thread affinity, valid after start()
+        std::thread::native_handle_type nativeHandle(size_t worker)
+        {
+            return workers[worker]->thread.native_handle();
+        }
+
+        uint64_t droppedPackets() const noexcept;
+        uint64_t processedPackets() const noexcept;
+
+    private:
+        struct Message {
+            enum class Kind : uint8_t {
+                NONE,
+                PACKET,
+                ATTACH,
+                DETACH,
+                TASK,
+            };
+
+            Kind kind = Kind::NONE;
+            ConnectionId id = 0;
+            Protocol::RawPacket packet{};
+            TimePoint arriveTime{};
+            std::unique_ptr<ObservedServer> server{};
+            Task task{};
+        };
+
+        struct Worker {
+            explicit Worker(size_t queueCapacity) : queue(queueCapacity) {}
+
+            Utility::SpscQueue<Message> queue;
+            std::thread thread{};
+
+            // Owned by the worker thread once it is running
+            Q3Huffman huffman{};
+            std::unordered_map<ConnectionId, std::unique_ptr<ObservedServer>> servers{};
+            Message current{};
+
+            std::atomic<uint64_t> dropped{};
+            std::atomic<uint64_t> processed{};
+
+            // Idle workers sleep until the producer wakes them up
+            std::mutex mutex{};
+            std::condition_variable wakeup{};
+            std::atomic<bool> sleeping{};
+        };
+
+        void run(Worker & worker);
+        void handle(Worker & worker, Message & message);
+        // Blocks until there is room for control messages, they must not be lost
+        void pushControl(Worker & worker, Message && message);
+        bool push(Worker & worker, Message && message);
+        void notify(Worker & worker);
+
+        std::vector<std::unique_ptr<Worker>> workers{};
+        std::atomic<bool> running{};
+        bool started = false;
+        ConnectionId nextId = 0;
+    };
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+#include "jka/JKAConstants.h"
+#include "jka/JKAEnums.h"
+
+namespace JKA {
+    // What a ServerPacketParser's consumer needs. The bitstream is still
+    // decoded in full, since later deltas are built on it, but whatever
+    // the consumer is not interested in is neither stored nor reported.
+    // Should be set before connecting to a server.
+    struct ParserInterests {
+        static constexpr size_t MAX_ENTITY_TYPES = 1 << 8;  // eType is sent in 8 bits
+
+        ParserInterests() noexcept
+        {
+            entityTypes.set();
+            configStrings.set();
+            configStringInfos.set();
+        }
+
+        // Entities of these types are kept in ClientGameState::currentEntities
+        // and reported through the entity callbacks and SnapshotDelta.
+        // Event entities have eType == ET_EVENTS + event.
+        std::bitset<MAX_ENTITY_TYPES> entityTypes{};
+
+        // The snapshot event queue, for all entities regardless of entityTypes
+        bool entityEvents = true;
+
+        // The local player's entity built from the playerstate
+        bool playerEntity = true;
+
+        // Stored in ClientGameState::configStrings and reported through
+        // onConfigstringChanged(). CS_SYSTEMINFO is always kept, the parser needs it.
+        std::bitset<MAX_CONFIGSTRINGS> configStrings{};
+        // Also parsed into ClientGameState::configStringsInfo
+        std::bitset<MAX_CONFIGSTRINGS> configStringInfos{};
+
+        // Keep the RMG heightmap in ClientGameState::compressedHeightmap
+        bool rmgData = true;
+
+        bool wantsEntityType(int32_t eType) const noexcept
+        {
+            return eType >= 0 && static_cast<size_t>(eType) < MAX_ENTITY_TYPES && entityTypes.test(eType);
+        }
+
+        bool wantsConfigString(size_t index) const noexcept
+        {
+            return index == CS_SYSTEMINFO || (index < MAX_CONFIGSTRINGS && configStrings.test(index));
+        }
+
+        bool wantsConfigStringInfo(size_t index) const noexcept
+        {
+            return index == CS_SYSTEMINFO || (index < MAX_CONFIGSTRINGS && configStringInfos.test(index));
+        }
+
+        // Configstrings [first, first + count)
+        void setConfigStrings(size_t first, size_t count, bool interested, bool parseInfo = false) noexcept
+        {
+            for (size_t i = first; i < first + count && i < MAX_CONFIGSTRINGS; i++) {
+                configStrings.set(i, interested);
+                configStringInfos.set(i, interested && parseInfo);
+            }
+        }
+
+        // Everything, the default
+        static ParserInterests all() noexcept
+        {
+            return ParserInterests();
+        }
+
+        // Only the snapshot event queue
+        static ParserInterests eventsOnly() noexcept
+        {
+            ParserInterests interests{};
+            interests.entityTypes.reset();
+            interests.playerEntity = false;
+            interests.configStrings.reset();
+            interests.configStringInfos.reset();
+            interests.rmgData = false;
+            return interests;
+        }
+
+        // Serverinfo and the players' infostrings, e.g. for "who is online" polling
+        static ParserInterests serverInfoOnly() noexcept
+        {
+            ParserInterests interests = eventsOnly();
+            interests.entityEvents = false;
+            interests.setConfigStrings(CS_SERVERINFO, 1, true, true);
+            interests.setConfigStrings(CS_PLAYERS, MAX_CLIENTS, true, true);
+            return interests;
+        }
+    };
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ServerAddress.h"
+#include "SharedDefs.h"
+#include "packets/ConnlessPacketView.h"
+#include "utility/Span.h"
+#include "utility/TimerWheel.h"
+
+namespace JKA {
+    // Runs rcon commands on many servers at once, queued per server.
+    // JKA's replies carry nothing to match them with: the output of a command
+    // comes as one or more print packets (SV_FlushRedirect), and nothing marks
+    // the last one. So a server runs one command at a time, every print from
+    // it goes to that command, and the command is done once no print has come
+    // for Options::quietTime. JKA also ignores an rcon which comes less than
+    // 500 ms after the previous one (SVC_RemoteCommand), hence minInterval.
+    // Does no I/O itself, like ServerCrawler.
+    class RconClient {
+    public:
+        using Duration = std::chrono::milliseconds;
+        using CommandId = uint64_t;
+
+        // Timer resolution
+        static constexpr Duration TICK{ 10 };
+
+        class Transport {
+        public:
+            virtual ~Transport() = default;
+            virtual void send(const ServerAddress & to, Utility::Span<const char> datagram) = 0;
+        };
+
+        struct Options {
+            Duration minInterval{ 600 };  // Between two rcons to a server
+            Duration quietTime{ 250 };    // After the last print of a reply
+            Duration timeout{ 2000 };     // For the first print
+            size_t maxQueued = 64;        // Commands per server
+        };
+
+        struct Result {
+            CommandId id = 0;
+            ServerAddress server{};
+            std::string command{};
+            std::string output{};   // The prints, concatenated
+            uint32_t packets = 0;
+            Duration latency{};     // Of the first print
+            // No print at all: lost, a wrong password which has been ignored,
+            // or a command without output
+            bool timedOut() const noexcept
+            {
+                return packets == 0;
+            }
+        };
+
+        using ResultCallback = std::function<void(Result && result)>;
+
+        struct Stats {
+            uint64_t sent = 0;
+            uint64_t completed = 0;
+            uint64_t timedOut = 0;
+            uint64_t prints = 0;
+            uint64_t ignored = 0;   // Prints from servers without a running command
+            uint64_t rejected = 0;  // Queue full
+        };
+
+        RconClient(Transport & transport_, Options options_, ResultCallback onResult_);
+        RconClient(const RconClient &) = delete;
+        RconClient(RconClient &&) = delete;
+        RconClient & operator=(const RconClient &) = delete;
+        RconClient & operator=(RconClient &&) = delete;
+        ~RconClient() = default;
+
+        // Queues "rcon <password> <command>". Returns 0 if the server's queue is full.
+        CommandId send(const ServerAddress & server, std::string_view password, std::string_view command, TimePoint now);
+
+        void handlePacket(const ServerAddress & from, const Packets::ConnlessPacketView & packet, TimePoint now);
+        // Expires the timers and sends the queued commands. Call it every TICK or so.
+        void poll(TimePoint now);
+
+        // Queued or running
+        size_t pending() const noexcept
+        {
+            return pendingCommands;
+        }
+
+        const Stats & getStats() const & noexcept
+        {
+            return stats;
+        }
+
+    private:
+        struct Command {
+            CommandId id;
+            std::string datagram;  // Ready to send
+            size_t commandOffset;  // Of the command in datagram
+        };
+
+        struct Server {
+            ServerAddress address{};
+            std::deque<Command> queue{};  // front() is running if busy
+            bool busy = false;
+            uint32_t generation = 0;
+            TimePoint nextSendAt{};
+            TimePoint sentAt{};
+            std::string output{};
+            uint32_t packets = 0;
+            Duration latency{};
+        };
+
+        struct Timer {
+            uint32_t index;
+            uint32_t generation;
+        };
+
+        void tryStart(size_t index, TimePoint now);
+        void complete(size_t index);
+
+        Transport & transport;
+        Options options;
+        ResultCallback onResult;
+
+        std::vector<Server> servers{};
+        std::unordered_map<uint64_t, uint32_t> serversByAddress{};
+        Utility::TimerWheel<Timer> timers;
+
+        CommandId lastId = 0;
+        size_t pendingCommands = 0;
+        Stats stats{};
+    };
+}
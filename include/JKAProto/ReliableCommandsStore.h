@@ -1,79 +1,159 @@
 #pragma once
+#include <algorithm>
 #include <array>
-#include <string>
+#include <cstdint>
 #include <string_view>
-#include <type_traits>
+#include <vector>
 
 #include "SharedDefs.h"
 #include "utility/Span.h"
 #include "jka/JKAConstants.h"
+#include "jka/JKAFunctions.h"
 
 namespace JKA {
-    class ReliableCommandsStore {
+    // A reliable command stored along with what the netchan derives from it
+    class ReliableCommand {
     public:
-        ReliableCommandsStore() noexcept = default;
-        ReliableCommandsStore(const ReliableCommandsStore & other) = default;
-        ReliableCommandsStore(ReliableCommandsStore && other) noexcept : ReliableCommandsStore()
+        // The original JKA truncates commands to char[MAX_STRING_CHARS]
+        static constexpr size_t CAPACITY = MAX_STRING_CHARS - 1;
+        // Com_HashKey() length used for the usercmd key
+        static constexpr size_t HASH_KEY_LEN = 32;
+
+        constexpr ReliableCommand() noexcept = default;
+
+        void assign(std::string_view command) noexcept
         {
-            swap(*this, other);
+            length = static_cast<uint16_t>(std::min(command.size(), CAPACITY));
+            std::copy_n(command.data(), length, text.data());
+            hash = Com_HashKey(view(), HASH_KEY_LEN);
+            buildKeystream();
         }
 
-        ReliableCommandsStore & operator=(ReliableCommandsStore other) noexcept
+        void clear() noexcept
         {
-            swap(*this, other);
-            return *this;
+            assign({});
         }
 
-        template<typename StateTA, typename StateTB>
-        friend
-            std::enable_if_t<
-                std::is_same_v<std::remove_reference_t<StateTA>, ReliableCommandsStore> &&
-                std::is_same_v<std::remove_reference_t<StateTB>, ReliableCommandsStore>
-            >
-        swap(StateTA && a, StateTB && b) noexcept
+        std::string_view view() const noexcept
         {
-            using std::swap;
-            swap(a.reliableCommands, b.reliableCommands);
-            swap(a.serverCommands, b.serverCommands);
+            return std::string_view(text.data(), length);
         }
 
-        void reset() noexcept
+        size_t size() const noexcept
         {
-            swap(*this, ReliableCommandsStore());
+            return length;
         }
 
-        std::string & reliableCommand(size_t sequence) & noexcept
+        bool empty() const noexcept
         {
-            return reliableCommands[reliableCommandsIdx(sequence)];
+            return length == 0;
         }
 
-        const std::string & reliableCommand(size_t sequence) const & noexcept
+        // Com_HashKey(command, 32)
+        int32_t hashKey() const noexcept
         {
-            return reliableCommands[reliableCommandsIdx(sequence)];
+            return hash;
         }
 
-        std::string & serverCommand(size_t sequence) & noexcept
+        // The netchan XORs the byte i of a packet with initialKey ^ period()[i % period().size()],
+        // and also with lapKey() if (i / period().size()) is odd (see detail::BasicEncoder)
+        Utility::Span<const uint8_t> period() const noexcept
         {
-            return serverCommands[serverCommandsIdx(sequence)];
+            return Utility::Span<const uint8_t>(keystream.data(), keystreamPeriod);
         }
 
-        const std::string & serverCommand(size_t sequence) const & noexcept
+        uint8_t lapKey() const noexcept
         {
-            return serverCommands[serverCommandsIdx(sequence)];
+            return keystreamLap;
         }
 
     private:
-        size_t reliableCommandsIdx(size_t sequence) const noexcept
+        // Byte i adds keyChar << (i & 1) to the running key, where keyChar cycles
+        // through the command ('%' read as '.'), so the running key only depends
+        // on the command and i modulo the even length covering the command
+        void buildKeystream() noexcept
+        {
+            if (length == 0) {
+                // rww: special case, keyChar is always 0
+                keystreamPeriod = 1;
+                keystream[0] = 0;
+                keystreamLap = 0;
+                return;
+            }
+
+            keystreamPeriod = (length % 2 == 0) ? length : length * 2;
+
+            uint8_t key = 0;
+            for (size_t i = 0; i < keystreamPeriod; i++) {
+                unsigned char keyChar = static_cast<unsigned char>(text[i % length]);
+                if (keyChar == '%') {
+                    keyChar = '.';
+                }
+
+                key ^= static_cast<uint8_t>(keyChar << (i & 1));
+                keystream[i] = key;
+            }
+            keystreamLap = key;
+        }
+
+        std::array<char, CAPACITY> text{};
+        uint16_t length = 0;
+        int32_t hash = 0;
+
+        std::array<uint8_t, CAPACITY * 2> keystream{};
+        size_t keystreamPeriod = 1;
+        uint8_t keystreamLap = 0;
+    };
+
+    class ReliableCommandsStore {
+    public:
+        ReliableCommandsStore() = default;
+        ReliableCommandsStore(const ReliableCommandsStore & other) = default;
+        ReliableCommandsStore(ReliableCommandsStore && other) noexcept = default;
+        ReliableCommandsStore & operator=(const ReliableCommandsStore & other) = default;
+        ReliableCommandsStore & operator=(ReliableCommandsStore && other) noexcept = default;
+        ~ReliableCommandsStore() = default;
+
+        void reset() noexcept
+        {
+            for (auto & command : reliableCommands) {
+                command.clear();
+            }
+            for (auto & command : serverCommands) {
+                command.clear();
+            }
+        }
+
+        // Client -> server
+        const ReliableCommand & reliableCommand(size_t sequence) const & noexcept
+        {
+            return reliableCommands[commandIdx(sequence)];
+        }
+
+        void setReliableCommand(size_t sequence, std::string_view command) noexcept
+        {
+            reliableCommands[commandIdx(sequence)].assign(command);
+        }
+
+        // Server -> client
+        const ReliableCommand & serverCommand(size_t sequence) const & noexcept
         {
-            return sequence % reliableCommands.size();
+            return serverCommands[commandIdx(sequence)];
         }
 
-        size_t serverCommandsIdx(size_t sequence) const noexcept
+        void setServerCommand(size_t sequence, std::string_view command) noexcept
+        {
+            serverCommands[commandIdx(sequence)].assign(command);
+        }
+
+    private:
+        static constexpr size_t commandIdx(size_t sequence) noexcept
         {
-            return sequence % reliableCommands.size();
+            return sequence % MAX_RELIABLE_COMMANDS;
         }
 
-        std::array<std::string, MAX_RELIABLE_COMMANDS> reliableCommands{};
-        std::array<std::string, JKA::MAX_RELIABLE_COMMANDS> serverCommands{};
+        // ~3 KiB per slot, kept off the stack
+        std::vector<ReliableCommand> reliableCommands = std::vector<ReliableCommand>(MAX_RELIABLE_COMMANDS);
+        std::vector<ReliableCommand> serverCommands = std::vector<ReliableCommand>(MAX_RELIABLE_COMMANDS);
     };
 }
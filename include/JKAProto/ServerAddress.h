@@ -0,0 +1,86 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+
+namespace JKA {
+    // An IPv4 address and a port, packed as in getserversResponse:
+    // 4 bytes of address, then 2 bytes of port, both big-endian
+    struct ServerAddress {
+        static constexpr size_t SIZE = 6;
+
+        constexpr ServerAddress() noexcept = default;
+        constexpr ServerAddress(uint32_t ip_, uint16_t port_) noexcept :
+            bytes{
+                static_cast<uint8_t>(ip_ >> 24), static_cast<uint8_t>(ip_ >> 16),
+                static_cast<uint8_t>(ip_ >> 8), static_cast<uint8_t>(ip_),
+                static_cast<uint8_t>(port_ >> 8), static_cast<uint8_t>(port_),
+            }
+        {
+        }
+
+        // SIZE bytes
+        static ServerAddress fromBytes(const char *data) noexcept
+        {
+            ServerAddress address;
+            std::memcpy(address.bytes.data(), data, SIZE);
+            return address;
+        }
+
+        constexpr uint32_t ip() const noexcept
+        {
+            return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16)
+                | (static_cast<uint32_t>(bytes[2]) << 8) | static_cast<uint32_t>(bytes[3]);
+        }
+
+        constexpr uint16_t port() const noexcept
+        {
+            return static_cast<uint16_t>((bytes[4] << 8) | bytes[5]);
+        }
+
+        // Unique per address
+        constexpr uint64_t key() const noexcept
+        {
+            return (static_cast<uint64_t>(ip()) << 16) | port();
+        }
+
+        // a.b.c.d:port
+        std::string toString() const
+        {
+            return std::to_string(bytes[0]) + '.' + std::to_string(bytes[1]) + '.'
+                + std::to_string(bytes[2]) + '.' + std::to_string(bytes[3]) + ':' + std::to_string(port());
+        }
+
+        constexpr bool operator==(const ServerAddress & other) const noexcept
+        {
+            return key() == other.key();
+        }
+
+        constexpr bool operator!=(const ServerAddress & other) const noexcept
+        {
+            return key() != other.key();
+        }
+
+        constexpr bool operator<(const ServerAddress & other) const noexcept
+        {
+            return key() < other.key();
+        }
+
+        std::array<uint8_t, SIZE> bytes{};
+    };
+
+    static_assert(sizeof(ServerAddress) == ServerAddress::SIZE);
+}
+
+namespace std {
+    template<>
+    struct hash<JKA::ServerAddress> {
+        size_t operator()(const JKA::ServerAddress & address) const noexcept
+        {
+            return std::hash<uint64_t>()(address.key());
+        }
+    };
+}
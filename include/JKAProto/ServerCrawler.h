@@ -0,0 +1,231 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "JKAInfo.h"
+#include "ServerAddress.h"
+#include "SharedDefs.h"
+#include "packets/ConnlessPacketView.h"
+#include "packets/Getstatus.h"
+#include "utility/Span.h"
+#include "utility/TimerWheel.h"
+
+namespace JKA {
+    inline boost::asio::ip::udp::endpoint toEndpoint(const ServerAddress & address)
+    {
+        return boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4(address.ip()), address.port());
+    }
+
+    // endpoint must be IPv4
+    inline ServerAddress toServerAddress(const boost::asio::ip::udp::endpoint & endpoint)
+    {
+        return ServerAddress(endpoint.address().to_v4().to_uint(), endpoint.port());
+    }
+
+    // Asks the masters for their server lists, then queries every listed
+    // server with getinfo and/or getstatus, many of them at once.
+    // Does no I/O itself: datagrams go out through a Transport, the replies
+    // are passed to handlePacket() and poll() runs the timers and the paced
+    // sends. UdpCrawlerTransport drives it with an asio socket, a test can
+    // drive it with anything.
+    // IPv4 only, like JKA.
+    class ServerCrawler {
+    public:
+        using Endpoint = boost::asio::ip::udp::endpoint;
+        using Duration = std::chrono::milliseconds;
+
+        // Timer resolution
+        static constexpr Duration TICK{ 10 };
+
+        class Transport {
+        public:
+            virtual ~Transport() = default;
+            virtual void send(const Endpoint & to, Utility::Span<const char> datagram) = 0;
+        };
+
+        struct Options {
+            std::vector<Endpoint> masters{};
+            std::string getserversArgs = "26 full empty";
+            bool queryInfo = true;
+            bool queryStatus = true;
+
+            Duration masterTimeout{ 2000 };  // Also how long a master's list may pause
+            Duration queryTimeout{ 1000 };
+            uint32_t retries = 2;            // Per server, after the first attempt
+
+            uint32_t sendRate = 2000;        // Datagrams per second, 0 for unlimited
+            uint32_t sendBurst = 64;
+            size_t maxInFlight = 4096;       // Servers queried but not done yet
+        };
+
+        struct ServerResult {
+            Endpoint endpoint{};
+            bool infoReceived = false;
+            bool statusReceived = false;
+            Duration ping{};  // Of the first reply, since the last attempt
+            uint32_t attempts = 0;
+
+            JKAInfo info{};
+            ServerStatus status{};
+
+            // Timed out without a single reply
+            bool timedOut() const noexcept
+            {
+                return !infoReceived && !statusReceived;
+            }
+        };
+
+        using ResultCallback = std::function<void(const ServerResult & result)>;
+
+        struct Stats {
+            uint64_t mastersAnswered = 0;
+            uint64_t serversListed = 0;    // Unique
+            uint64_t serversAnswered = 0;
+            uint64_t serversTimedOut = 0;
+            uint64_t sent = 0;
+            uint64_t received = 0;
+            uint64_t ignored = 0;          // Unknown sender, wrong challenge, unparsable
+        };
+
+        ServerCrawler(Transport & transport_, Options options_, ResultCallback onResult_);
+        ServerCrawler(const ServerCrawler &) = delete;
+        ServerCrawler(ServerCrawler &&) = delete;
+        ServerCrawler & operator=(const ServerCrawler &) = delete;
+        ServerCrawler & operator=(ServerCrawler &&) = delete;
+        ~ServerCrawler() = default;
+
+        // Sends getservers to the masters
+        void start(TimePoint now);
+        // Queries a server directly. Known servers are ignored.
+        void addServer(const Endpoint & server);
+
+        void handlePacket(const Endpoint & from, std::string_view data, TimePoint now);
+        // Expires the timers and sends what the rate allows. Call it every TICK or so.
+        void poll(TimePoint now);
+
+        // Every master and every server is done
+        bool done() const noexcept;
+
+        const Stats & getStats() const & noexcept
+        {
+            return stats;
+        }
+
+    private:
+        enum : uint8_t {
+            QUERY_INFO = 1 << 0,
+            QUERY_STATUS = 1 << 1,
+        };
+
+        struct Master {
+            Endpoint endpoint{};
+            uint32_t attempts = 0;
+            uint32_t generation = 0;
+            bool answered = false;
+            bool finished = false;
+        };
+
+        struct Target {
+            ServerResult result{};
+            std::array<char, 8> challenge{};
+            uint32_t generation = 0;
+            uint8_t pending = 0;  // QUERY_*
+            bool inFlight = false;
+            bool finished = false;
+            TimePoint sentAt{};
+        };
+
+        struct Timer {
+            uint32_t index;
+            uint32_t generation;
+            bool master;
+        };
+
+        std::string_view challengeOf(const Target & target) const noexcept
+        {
+            return std::string_view(target.challenge.data(), target.challenge.size());
+        }
+
+        void sendMaster(size_t index, TimePoint now);
+        void sendQueries(size_t index, TimePoint now);
+        void send(const Endpoint & to, ConnlessType type, std::string_view data);
+        void flushSends(TimePoint now);
+        void onTimer(const Timer & timer, TimePoint now);
+        void onServersList(const Endpoint & from, std::string_view data, TimePoint now);
+        void onServerReply(const Endpoint & from, ConnlessType type, std::string_view data, TimePoint now);
+        void finish(size_t index);
+
+        Transport & transport;
+        Options options;
+        ResultCallback onResult;
+
+        std::vector<Master> masters{};
+        std::vector<Target> targets{};
+        std::unordered_map<uint64_t, uint32_t> targetsByAddress{};
+        std::deque<uint32_t> newTargets{};
+        std::deque<uint32_t> retries{};
+        size_t inFlight = 0;
+        size_t unfinished = 0;
+
+        Utility::TimerWheel<Timer> timers;
+
+        double tokens = 0;
+        TimePoint lastRefill{};
+
+        std::mt19937_64 rng;
+        std::vector<char> sendBuffer{};
+        ServerStatusView statusView{};  // Reused for every statusResponse
+        Stats stats{};
+    };
+
+    // Collects ServerCrawler results column by column
+    struct CrawlResults {
+        enum : uint8_t {
+            INFO_RECEIVED = 1 << 0,
+            STATUS_RECEIVED = 1 << 1,
+        };
+
+        void add(const ServerCrawler::ServerResult & result);
+
+        size_t size() const noexcept
+        {
+            return endpoints.size();
+        }
+
+        std::vector<ServerCrawler::Endpoint> endpoints{};
+        std::vector<uint8_t> flags{};
+        std::vector<int32_t> pings{};  // ms
+        std::vector<JKAInfo> infos{};
+        std::vector<ServerStatus> statuses{};
+    };
+
+    // Drives a ServerCrawler with a UDP socket
+    class UdpCrawlerTransport : public ServerCrawler::Transport {
+    public:
+        explicit UdpCrawlerTransport(boost::asio::ip::udp::socket & socket_) : socket(socket_) {}
+
+        void send(const ServerCrawler::Endpoint & to, Utility::Span<const char> datagram) override;
+
+        // Runs io until the crawler is done
+        void run(boost::asio::io_context & io, ServerCrawler & crawler);
+
+        uint64_t sendErrors() const noexcept
+        {
+            return errors;
+        }
+
+    private:
+        boost::asio::ip::udp::socket & socket;
+        uint64_t errors = 0;
+    };
+}
@@ -1,11 +1,17 @@
 #pragma once
+#include <array>
 #include <sstream>
+#include <vector>
 
+#include "ChangeJournal.h"
 #include "ClientGameState.h"
 #include "ClientConnection.h"
 #include "CommandExecutor.h"
+#include "GameStatePublisher.h"
 #include "ClientEventsListener.h"
+#include "ParserInterests.h"
 #include "ReliableCommandsStore.h"
+#include "SnapshotEventsListener.h"
 #include "packets/ConnlessPacket.h"
 #include "protocol/ServerPacket.h"
 #include "protocol/Netchan.h"
@@ -29,11 +35,44 @@ namespace JKA {
         void handleConnfullPacketFromServer(Protocol::ServerPacket & packet,
                                             TimePoint arriveTime);
 
+        // Same as above, but the snapshot parsed from the packet (if any)
+        // is also delivered to a statically dispatched listener
+        // after the whole packet has been handled
+        template<typename Derived>
+        void handleConnfullPacketFromServer(Protocol::ServerPacket & packet,
+                                            TimePoint arriveTime,
+                                            StaticSnapshotEventsListener<Derived> & snapshotListener)
+        {
+            handleConnfullPacketFromServer(packet, arriveTime);
+            if (snapshotParsed) {
+                snapshotListener.dispatchSnapshot(lastSnapshotDelta());
+            }
+        }
+
         void connectSent(JKAInfo info);
 
+        // nullptr to remove the listener
+        void setSnapshotListener(SnapshotEventsListener *listener) noexcept;
+        // Turn off the per-entity ClientEventsListener callbacks if
+        // the snapshot-level ones are enough
+        void setEntityCallbacksEnabled(bool enabled) noexcept;
+        // Publishes the game state after every valid snapshot; nullptr to stop
+        void setPublisher(GameStatePublisher *newPublisher) noexcept;
+        // Appends every change made to the game state; nullptr to stop
+        void setJournal(ChangeJournal *newJournal) noexcept;
+
+        void setInterests(const ParserInterests & newInterests);
+        const ParserInterests & getInterests() const & noexcept;
+
+        // The entity changes made by the last parsed snapshot.
+        // delta.snapshot is nullptr if the snapshot was not valid.
+        SnapshotDelta lastSnapshotDelta() const noexcept;
+        // The entity events of the last parsed snapshot
+        Utility::Span<const SnapshotEvent> lastSnapshotEvents() const noexcept;
+
     private:
-        // TODO: thread_local?
-        static Huffman huffman;
+        // Parsers may run on several threads (see ParserExecutor)
+        static thread_local Huffman huffman;
 
         // Connected to a new server
         void reset(int32_t newChallenge = 0);
@@ -60,17 +99,26 @@ namespace JKA {
                                  clSnapshot_t *oldframe, clSnapshot_t *newframe);
         void parseDeltaEntity(Protocol::CompressedMessage & message,
                               clSnapshot_t *frame, int32_t newnum,
-                              entityState_t *old, bool unchanged);
+                              const entityState_t *old);
+        // The entity at oldParseNum of the delta frame was not sent
+        void keepUnchangedEntity(clSnapshot_t *frame, size_t oldParseNum);
 
         CEntity & getEntity(size_t index) &;
         const CEntity & getEntity(size_t index) const &;
 
-        entityState_t & parsedEntity(size_t parseNum, size_t index = 0) &;
         const JKA::entityState_t & parsedEntity(size_t parseNum, size_t index = 0) const &;
 
         void onEntityRemoved(CEntity & curEnt);
-        void onEntityAdded(CEntity & curEnt, JKA::entityState_t & newState);
-        void onEntityChanged(CEntity & curEnt, JKA::entityState_t & newState);
+        void onEntityAdded(CEntity & curEnt, JKA::entityState_t & newState, int32_t serverTime);
+        void onEntityChanged(CEntity & curEnt, JKA::entityState_t & newState, int32_t serverTime);
+        // Indexes the entity at its origin at serverTime
+        void updateEntityGrid(const entityState_t & state, int32_t serverTime);
+
+        void queueEntityEvent(const entityState_t & state, int32_t serverTime);
+        void queuePlayerstateEvents(const playerState_t & ops, const playerState_t & ps, int32_t serverTime);
+
+        void deliverSnapshotDelta(const Snapshot *snapshot);
+        void journalSnapshotDelta(int32_t messageNum);
 
         // Server reliable commands
         void initCommands();
@@ -93,6 +141,68 @@ namespace JKA {
 
         CommandExecutor executor{};
 
+        // Entity changes of the snapshot being parsed
+        struct SnapshotDeltaBuffer {
+            std::vector<EntityDelta> added{};
+            std::vector<EntityDelta> changed{};
+            std::vector<EntityDelta> removed{};
+
+            void clear() noexcept
+            {
+                added.clear();
+                changed.clear();
+                removed.clear();
+            }
+        };
+
+        // Entity events of the snapshot being parsed. An entity fires at most
+        // one event per snapshot, the local player up to MAX_PS_EVENTS + 1.
+        struct SnapshotEventQueue {
+            static constexpr size_t CAPACITY = MAX_GENTITIES + MAX_PS_EVENTS + 1;
+
+            std::array<SnapshotEvent, CAPACITY> events{};
+            size_t count = 0;
+
+            void push(const SnapshotEvent & event) noexcept
+            {
+                if (count < CAPACITY) JKA_LIKELY {
+                    events[count++] = event;
+                }
+            }
+
+            void clear() noexcept
+            {
+                count = 0;
+            }
+        };
+
+        SnapshotDeltaBuffer entityDeltas{};
+        SnapshotEventQueue snapshotEvents{};
+        const Snapshot *deltaSnapshot = nullptr;
+        // Decodes the invalid snapshots whose slot is the current snapshot's
+        Snapshot scratchSnapshot{};
+        bool snapshotParsed = false;  // During the current packet
+        // Of the snapshot being parsed. Invalid ones fire no entity events,
+        // and leave entityEventStates as the last valid one has left them.
+        bool snapshotValid = false;
+
+        // What queueEntityEvent() compares a new entity state with,
+        // kept whether the entity is in currentEntities or not
+        struct EntityEventState {
+            int32_t eType = 0;
+            int32_t event = 0;
+            int32_t eventParm = 0;
+            bool present = false;
+        };
+
+        std::array<EntityEventState, MAX_GENTITIES> entityEventStates{};
+
+        SnapshotEventsListener *snapshotListener = nullptr;
+        GameStatePublisher *publisher = nullptr;
+        ChangeJournal *journal = nullptr;
+        bool entityCallbacksEnabled = true;
+        ParserInterests interests{};
+
         std::ostringstream bigInfoStringBuffer{};  // For bcs0/bcs1/bcs2 server commands
     };
 }
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+
+#include "jka/JKADefsNet.h"
+#include "jka/JKAEvents.h"
+#include "utility/Span.h"
+#include "Snapshot.h"
+
+namespace JKA {
+    // A single entity that was added, changed or removed by a snapshot
+    struct EntityDelta {
+        int32_t number = 0;
+        // Fields present in the delta; empty for removed entities
+        EntityFieldMask changedFields{};
+    };
+
+    // An entity event decoded from a snapshot: a new entityState_t::event
+    // of a regular entity, an event entity (eType > ET_EVENTS) or
+    // a playerstate event of the local player
+    struct SnapshotEvent {
+        int32_t entityNum = 0;
+        entity_event_t event = entity_event_t::EV_NONE;
+        int32_t eventParm = 0;
+        int32_t serverTime = 0;  // Of the snapshot the event came with
+    };
+
+    // All the entity changes of one parsed snapshot.
+    // The spans are valid until the next snapshot is parsed.
+    struct SnapshotDelta {
+        const Snapshot *snapshot = nullptr;
+
+        Utility::Span<const EntityDelta> added{};
+        Utility::Span<const EntityDelta> changed{};
+        Utility::Span<const EntityDelta> removed{};
+
+        Utility::Span<const SnapshotEvent> events{};  // In the order they were parsed
+
+        bool empty() const noexcept
+        {
+            return added.size() == 0 && changed.size() == 0 && removed.size() == 0
+                && events.size() == 0;
+        }
+    };
+
+    // Snapshot-level alternative to the per-entity ClientEventsListener callbacks:
+    // a single virtual call per parsed snapshot, made after the whole
+    // snapshot has been decoded.
+    struct SnapshotEventsListener {
+        SnapshotEventsListener() = default;
+        SnapshotEventsListener(const SnapshotEventsListener &) = delete;
+        SnapshotEventsListener(SnapshotEventsListener &&) = delete;
+        virtual ~SnapshotEventsListener() = default;
+
+        virtual void onSnapshotParsed([[maybe_unused]] const SnapshotDelta & delta) {}
+    };
+
+    // Statically dispatched (CRTP) version of SnapshotEventsListener.
+    // Derived may hide any of the handlers below; the ones it does not
+    // hide are empty and are optimized away.
+    //
+    // struct MyListener : StaticSnapshotEventsListener<MyListener> {
+    //     void onEntityAdded(const EntityDelta & delta) { ... }
+    // };
+    //
+    // parser.handleConnfullPacketFromServer(packet, arriveTime, myListener);
+    template<typename Derived>
+    struct StaticSnapshotEventsListener {
+        void dispatchSnapshot(const SnapshotDelta & delta)
+        {
+            auto & self = static_cast<Derived &>(*this);
+
+            self.onSnapshotBegin(delta);
+            for (const auto & removed : delta.removed) {
+                self.onEntityRemoved(removed);
+            }
+            for (const auto & added : delta.added) {
+                self.onEntityAdded(added);
+            }
+            for (const auto & changed : delta.changed) {
+                self.onEntityChanged(changed);
+            }
+            for (const auto & event : delta.events) {
+                self.onEntityEvent(event);
+            }
+            self.onSnapshotEnd(delta);
+        }
+
+        void onSnapshotBegin([[maybe_unused]] const SnapshotDelta & delta) {}
+        void onEntityRemoved([[maybe_unused]] const EntityDelta & delta) {}
+        void onEntityAdded([[maybe_unused]] const EntityDelta & delta) {}
+        void onEntityChanged([[maybe_unused]] const EntityDelta & delta) {}
+        void onEntityEvent([[maybe_unused]] const SnapshotEvent & event) {}
+        void onSnapshotEnd([[maybe_unused]] const SnapshotDelta & delta) {}
+
+    protected:
+        StaticSnapshotEventsListener() = default;
+        ~StaticSnapshotEventsListener() = default;
+    };
+}
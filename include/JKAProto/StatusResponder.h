@@ -0,0 +1,82 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "ClientGameState.h"
+#include "jka/JKAConstants.h"
+#include "packets/ConnlessPacketView.h"
+#include "utility/Span.h"
+
+namespace JKA {
+    // Answers getinfo and getstatus the way a JKA server does (SVC_Info, SVC_Status),
+    // from the serverinfo and player configstrings of a ClientGameState and from
+    // the scores set by the caller. The replies are kept prebuilt around the
+    // challenge, which is the only part that depends on the request, and are
+    // rebuilt only after the data they contain has changed. Answering is then
+    // a few memcpy's.
+    class StatusResponder {
+    public:
+        struct Stats {
+            uint64_t infoRebuilds = 0;
+            uint64_t statusRebuilds = 0;
+            uint64_t replies = 0;
+        };
+
+        StatusResponder() = default;
+        StatusResponder(const StatusResponder &) = default;
+        StatusResponder(StatusResponder &&) noexcept = default;
+        StatusResponder & operator=(const StatusResponder &) = default;
+        StatusResponder & operator=(StatusResponder &&) noexcept = default;
+        ~StatusResponder() = default;
+
+        // Takes the serverinfo and the player names, if any configstring has changed
+        void update(const ClientGameState & gameState);
+        // Not in the configstrings (see the "scores" server command)
+        void setPlayerScore(size_t clientNum, int32_t score, int32_t ping);
+
+        // The reply to a getinfo or getstatus request, written into buffer.
+        // Returns its size, 0 for other packets or if the buffer is too small.
+        size_t respond(const Packets::ConnlessPacketView & request, Utility::Span<char> buffer);
+        size_t respondInfo(std::string_view challenge, Utility::Span<char> buffer);
+        size_t respondStatus(std::string_view challenge, Utility::Span<char> buffer);
+
+        const Stats & getStats() const & noexcept
+        {
+            return stats;
+        }
+
+    private:
+        struct Player {
+            std::string configString{};
+            std::string name{};
+            int32_t score = 0;
+            int32_t ping = 0;
+            bool present = false;
+        };
+
+        // A reply is head + challenge + tail
+        struct Prebuilt {
+            std::string head{};             // Up to the challenge's value
+            std::string headNoChallenge{};  // Same, without the challenge key
+            std::string tail{};
+            bool dirty = true;
+        };
+
+        static size_t write(const Prebuilt & reply, std::string_view challenge, Utility::Span<char> buffer) noexcept;
+
+        void rebuildInfo();
+        void rebuildStatus();
+
+        uint64_t configStringsVersion = 0;
+        bool updated = false;
+        std::string serverInfo{};
+        std::array<Player, MAX_CLIENTS> players{};
+
+        Prebuilt info{};
+        Prebuilt status{};
+        Stats stats{};
+    };
+}
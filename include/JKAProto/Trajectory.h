@@ -0,0 +1,149 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "ClientGameState.h"
+#include "Geometry.h"
+#include "Snapshot.h"
+#include "jka/JKAConstants.h"
+#include "jka/JKAStructs.h"
+
+namespace JKA {
+    // Structure-of-arrays copy of up to MAX_GENTITIES trajectory_t's.
+    // Arrays are kept separate so that evaluate() compiles into
+    // straight vector loops.
+    class TrajectoryArrays {
+    public:
+        static constexpr size_t CAPACITY = MAX_GENTITIES;
+
+        void clear() noexcept;
+        void push_back(const trajectory_t & tr) noexcept;
+
+        size_t size() const noexcept
+        {
+            return count;
+        }
+
+        // BG_EvaluateTrajectory() for every stored trajectory;
+        // outX/outY/outZ must hold at least size() floats
+        void evaluate(int32_t atTime, float *outX, float *outY, float *outZ) const noexcept;
+
+    private:
+        size_t count = 0;
+
+        alignas(64) std::array<int32_t, CAPACITY> trType{};
+        alignas(64) std::array<int32_t, CAPACITY> trTime{};
+        alignas(64) std::array<int32_t, CAPACITY> trDuration{};
+
+        alignas(64) std::array<float, CAPACITY> baseX{};
+        alignas(64) std::array<float, CAPACITY> baseY{};
+        alignas(64) std::array<float, CAPACITY> baseZ{};
+        alignas(64) std::array<float, CAPACITY> deltaX{};
+        alignas(64) std::array<float, CAPACITY> deltaY{};
+        alignas(64) std::array<float, CAPACITY> deltaZ{};
+
+        // TR_SINE, TR_NONLINEAR_STOP and unknown types need trigonometry
+        // or are rare enough to be evaluated one by one after the vector pass
+        std::array<uint16_t, CAPACITY> scalarIndices{};
+        size_t scalarCount = 0;
+    };
+
+    // Evaluated origins and angles of a set of entities
+    struct EntityPositions {
+        size_t count = 0;
+
+        alignas(64) std::array<int32_t, MAX_GENTITIES> number{};
+
+        alignas(64) std::array<float, MAX_GENTITIES> originX{};
+        alignas(64) std::array<float, MAX_GENTITIES> originY{};
+        alignas(64) std::array<float, MAX_GENTITIES> originZ{};
+
+        alignas(64) std::array<float, MAX_GENTITIES> pitch{};
+        alignas(64) std::array<float, MAX_GENTITIES> yaw{};
+        alignas(64) std::array<float, MAX_GENTITIES> roll{};
+
+        Vec3 origin(size_t idx) const noexcept
+        {
+            return Vec3(originX[idx], originY[idx], originZ[idx]);
+        }
+
+        AnglesIngame angles(size_t idx) const noexcept
+        {
+            return AnglesIngame(pitch[idx], yaw[idx], roll[idx]);
+        }
+    };
+
+    // pos/apos trajectories of a set of entities
+    class EntityTrajectories {
+    public:
+        static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+        EntityTrajectories() noexcept;
+
+        void clear() noexcept;
+        void add(const entityState_t & state) noexcept;
+
+        // All valid ClientGameState::currentEntities
+        void loadCurrentEntities(const ClientGameState & gameState) noexcept;
+        // Entities of a snapshot from gameState.snapshots, including
+        // the player the snapshot was built for
+        void loadSnapshot(const ClientGameState & gameState, const Snapshot & snapshot) noexcept;
+
+        size_t size() const noexcept
+        {
+            return pos.size();
+        }
+
+        int32_t number(size_t idx) const noexcept
+        {
+            return numbers[idx];
+        }
+
+        // NPOS if the entity is not loaded
+        size_t indexOf(int32_t entityNum) const noexcept;
+
+        void evaluate(int32_t atTime, EntityPositions & out) const noexcept;
+
+    private:
+        void addPlayer(const playerState_t & ps) noexcept;
+
+        std::array<int32_t, MAX_GENTITIES> numbers{};
+        std::array<int16_t, MAX_GENTITIES> indices{};  // Entity number -> index, -1 if absent
+
+        TrajectoryArrays pos{};
+        TrajectoryArrays apos{};
+    };
+
+    // Positions of the entities between two snapshots, the way cgame
+    // computes them: TR_INTERPOLATE trajectories are lerped from one
+    // snapshot to the other, everything else is evaluated at the
+    // requested time.
+    class EntityInterpolator {
+    public:
+        // from.snap.serverTime should be less than to.snap.serverTime
+        void setSnapshots(const ClientGameState & gameState,
+                          const Snapshot & from,
+                          const Snapshot & to) noexcept;
+
+        // Entities of the 'from' snapshot at atTime
+        void evaluate(int32_t atTime, EntityPositions & out) const noexcept;
+
+        const EntityTrajectories & trajectories() const & noexcept
+        {
+            return current;
+        }
+
+    private:
+        EntityTrajectories current{};
+        EntityTrajectories next{};
+
+        int32_t fromTime = 0;
+        int32_t toTime = 0;
+
+        // Indexed the same way as current; lerp is 1.0f for the interpolated entities
+        alignas(64) std::array<float, MAX_GENTITIES> lerp{};
+        EntityPositions nextPositions{};
+        EntityPositions scratch{};
+    };
+}
@@ -27,6 +27,7 @@ namespace JKA {
     static constexpr auto    MAX_INFO_LEN = 4096;
     static constexpr auto    MAX_BIG_STRING = 8192;
     static constexpr auto    MAX_STRING_CHARS = 1024;
+    static constexpr char    Q_COLOR_ESCAPE = '^';
     static constexpr auto    MAX_RELIABLE_COMMANDS = 128;
 
     static constexpr auto    SV_ENCODE_START = 8;
@@ -53,6 +54,13 @@ namespace JKA {
     static constexpr auto    YAW = 1;      // left / right
     static constexpr auto    ROLL = 2;     // fall over
 
+    // for trajectory_t
+    static constexpr auto    DEFAULT_GRAVITY = 800;
+
+    // for world bounds
+    static constexpr auto    MAX_WORLD_COORD = 64 * 1024;
+    static constexpr auto    MIN_WORLD_COORD = -64 * 1024;
+
     // for gameState_t
     static constexpr auto    MAX_GAMESTATE_CHARS = 16000;
     static constexpr auto    MAX_CONFIGSTRINGS = 1700;
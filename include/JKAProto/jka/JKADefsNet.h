@@ -1,5 +1,6 @@
 #pragma once
 #include <array>
+#include <bitset>
 #include <cstddef>
 #include <cstdint>
 #include <string_view>
@@ -210,6 +211,10 @@ namespace JKA
         netField_t{ NETF(userVec2[2]), 1 }
     };
 
+    // rww: not an actual JKA define.
+    // Bit N is set if entityStateFields[N] was present in a delta
+    using EntityFieldMask = std::bitset<entityStateFields.size()>;
+
     inline constexpr std::array playerStateFields
     {
         netField_t{ PSF(commandTime), 32 },
@@ -90,6 +90,8 @@ namespace JKA
 
         CLS_DISCONNECT,
 
+        CLS_HEARTBEAT,
+
         CLS__MAX,
         CLS__END = CLS__MAX,
         CLS__BAD = CLS__MAX
@@ -1,4 +1,5 @@
 #pragma once
+#include <string>
 #include <string_view>
 #include <cinttypes>
 #include "JKAStructs.h"
@@ -19,10 +20,32 @@ namespace JKA
         to[2] += from[2];
     }
 
+    inline void VectorMA(const vec3_t & veca, float scale, const vec3_t & vecb, vec3_t & vecc)
+    {
+        vecc[0] = veca[0] + scale * vecb[0];
+        vecc[1] = veca[1] + scale * vecb[1];
+        vecc[2] = veca[2] + scale * vecb[2];
+    }
+
     int32_t Com_HashKey(std::string_view string, size_t maxLen);
 
+    // Removes the ^0..^9 colour codes in place, until there are none left
+    // ("^^11" -> ""). Returns the new length.
+    size_t Q_StripColor(char *text, size_t length) noexcept;
+
+    // Any std::basic_string<char>
+    template<typename String>
+    void Q_StripColor(String & text)
+    {
+        text.resize(Q_StripColor(text.data(), text.size()));
+    }
+
     void BG_PlayerStateToEntityState(playerState_t &ps, entityState_t &s);
 
+    void BG_EvaluateTrajectory(const trajectory_t & tr, int32_t atTime, vec3_t & result);
+
+    float LerpAngle(float from, float to, float frac);
+
     inline int32_t ANGLE2SHORT(float angle)
     {
         return ((int32_t)((angle) * 65536 / 360) & 65535);
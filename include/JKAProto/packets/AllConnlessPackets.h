@@ -5,6 +5,7 @@
 #include "Connect.h"
 
 #include "Getservers.h"
+#include "Heartbeat.h"
 
 #include "Rcon.h"
 #include "Print.h"
@@ -1,9 +1,10 @@
 #pragma once
-#include <sstream>
 #include <string>
 #include <string_view>
 #include "../jka/JKADefs.h"
 #include "../jka/JKAConstants.h"
+#include "../utility/Span.h"
+#include "ConnlessSerializer.h"
 
 namespace JKA {
     namespace Packets {
@@ -26,11 +27,28 @@ namespace JKA {
                 return CONNLESS_PACKETS[getType()].name;
             }
 
+            // The part after the name and the separator
+            virtual std::string_view getDataView() const noexcept
+            {
+                return {};
+            }
+
+            size_t serializedSize() const noexcept
+            {
+                return ConnlessSerializer::serializedSize(getType(), getDataView());
+            }
+
+            // Returns the number of bytes written, 0 if the buffer is too small
+            size_t serialize(Utility::Span<char> buffer) const noexcept
+            {
+                return ConnlessSerializer::serialize(getType(), getDataView(), buffer);
+            }
+
             virtual std::string getRawPacket() const
             {
-                std::ostringstream ss;
-                ss << CONNLESS_PREFIX_S << getName();
-                return ss.str();
+                std::string rawPacket(serializedSize(), '\0');
+                serialize(Utility::Span(rawPacket));
+                return rawPacket;
             }
 
         protected:
@@ -60,21 +78,14 @@ namespace JKA {
                 return data;
             }
 
-            virtual void setData(std::string_view newData)
+            virtual std::string_view getDataView() const noexcept override
             {
-                data = newData;
+                return data;
             }
 
-            virtual std::string getRawPacket() const override
+            virtual void setData(std::string_view newData)
             {
-                auto basePacket = ConnlessPacket::getRawPacket();
-                if (data.empty()) {
-                    return basePacket;
-                } else {
-                    std::ostringstream ss;
-                    ss << basePacket << getSeparator() << getData();
-                    return ss.str();
-                }
+                data = newData;
             }
 
         protected:
@@ -1,7 +1,16 @@
 #pragma once
 #include <memory>
 #include "ConnlessPacket.h"
+#include "ConnlessPacketView.h"
 
 namespace JKA::Packets::ConnlessPacketFactory {
+    // Parses in place, without allocating: the view points into rawPacket.
+    // false (and std::monostate) if rawPacket is not a known connless packet.
+    bool parsePacket(std::string_view rawPacket, ConnlessPacketView & packet) noexcept;
+
+    // nullptr if rawPacket is not a known connless packet
     std::unique_ptr<ConnlessPacket> parsePacket(std::string_view rawPacket);
+
+    // An owning packet built from the view, nullptr for std::monostate
+    std::unique_ptr<ConnlessPacket> makePacket(const ConnlessPacketView & packet);
 }
@@ -0,0 +1,75 @@
+#pragma once
+#include <string_view>
+#include <type_traits>
+#include <variant>
+
+#include "../jka/JKADefs.h"
+
+namespace JKA {
+    namespace Packets {
+        // A connless packet parsed in place: data points into the raw packet,
+        // which must outlive the view
+        template<ConnlessType Type>
+        struct ConnlessView {
+            static constexpr ConnlessType TYPE = Type;
+
+            std::string_view data{};
+
+            static constexpr ConnlessType getType() noexcept
+            {
+                return Type;
+            }
+
+            static constexpr std::string_view getName() noexcept
+            {
+                return CONNLESS_PACKETS[Type].name;
+            }
+
+            static constexpr std::string_view getSeparator() noexcept
+            {
+                return CONNLESS_PACKETS[Type].separator;
+            }
+        };
+
+        // GetinfoView, GetstatusView, ...
+#define CONLESS_PACKETS_LIST_ENTRY(type_, cls_name, str, sep) using cls_name##View = ConnlessView<type_>;
+        #include "../data/ConnlessPacketsList.inc"
+#undef CONLESS_PACKETS_LIST_ENTRY
+
+        // std::monostate if no packet has been parsed, then one alternative
+        // per ConnlessType, in the same order
+#define CONLESS_PACKETS_LIST_ENTRY(type_, cls_name, str, sep) , ConnlessView<type_>
+        using ConnlessPacketView = std::variant<
+            std::monostate
+            #include "../data/ConnlessPacketsList.inc"
+        >;
+#undef CONLESS_PACKETS_LIST_ENTRY
+
+#define CONLESS_PACKETS_LIST_ENTRY(type_, cls_name, str, sep)                               \
+        static_assert(std::is_same_v<std::variant_alternative_t<type_ + 1, ConnlessPacketView>, \
+                                     ConnlessView<type_>>);
+        #include "../data/ConnlessPacketsList.inc"
+#undef CONLESS_PACKETS_LIST_ENTRY
+
+        // CLS__BAD for std::monostate
+        constexpr ConnlessType getType(const ConnlessPacketView & packet) noexcept
+        {
+            if (packet.index() == 0) {
+                return CLS__BAD;
+            }
+            return static_cast<ConnlessType>(packet.index() - 1);
+        }
+
+        // Everything after the name and its separator
+        constexpr std::string_view getData(const ConnlessPacketView & packet) noexcept
+        {
+            return std::visit([](const auto & view) -> std::string_view {
+                if constexpr (std::is_same_v<std::decay_t<decltype(view)>, std::monostate>) {
+                    return {};
+                } else {
+                    return view.data;
+                }
+            }, packet);
+        }
+    }
+}
@@ -0,0 +1,162 @@
+#pragma once
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "../SharedDefs.h"
+#include "../jka/JKADefs.h"
+#include "../jka/JKAConstants.h"
+#include "../utility/Span.h"
+#include "ConnlessPacketView.h"
+
+// Writes connless packets into caller-provided buffers:
+//   <CONNLESS_PREFIX><name>[<separator><data>]
+// The data part is omitted if it is empty.
+namespace JKA::Packets::ConnlessSerializer {
+    // Exact number of bytes serialize() writes
+    constexpr size_t serializedSize(ConnlessType type, std::string_view data) noexcept
+    {
+        const auto & def = CONNLESS_PACKETS[type];
+        size_t size = CONNLESS_PREFIX_SIZE + def.name.size();
+        if (!data.empty()) {
+            size += def.separator.size() + data.size();
+        }
+        return size;
+    }
+
+    // Returns the number of bytes written, 0 if the buffer is too small
+    inline size_t serialize(ConnlessType type, std::string_view data, Utility::Span<char> buffer) noexcept
+    {
+        size_t size = serializedSize(type, data);
+        if (size > buffer.size()) JKA_UNLIKELY {
+            return 0;
+        }
+
+        const auto & def = CONNLESS_PACKETS[type];
+        char *out = buffer.data();
+        std::memcpy(out, CONNLESS_PREFIX_C, CONNLESS_PREFIX_SIZE);
+        out += CONNLESS_PREFIX_SIZE;
+        std::memcpy(out, def.name.data(), def.name.size());
+        out += def.name.size();
+        if (!data.empty()) {
+            std::memcpy(out, def.separator.data(), def.separator.size());
+            out += def.separator.size();
+            std::memcpy(out, data.data(), data.size());
+        }
+        return size;
+    }
+
+    template<ConnlessType Type>
+    constexpr size_t serializedSize(const ConnlessView<Type> & packet) noexcept
+    {
+        return serializedSize(Type, packet.data);
+    }
+
+    template<ConnlessType Type>
+    size_t serialize(const ConnlessView<Type> & packet, Utility::Span<char> buffer) noexcept
+    {
+        return serialize(Type, packet.data, buffer);
+    }
+
+    // 0 for std::monostate
+    constexpr size_t serializedSize(const ConnlessPacketView & packet) noexcept
+    {
+        if (getType(packet) == CLS__BAD) {
+            return 0;
+        }
+        return serializedSize(getType(packet), getData(packet));
+    }
+
+    inline size_t serialize(const ConnlessPacketView & packet, Utility::Span<char> buffer) noexcept
+    {
+        if (getType(packet) == CLS__BAD) {
+            return 0;
+        }
+        return serialize(getType(packet), getData(packet), buffer);
+    }
+
+    // Many packets serialized back to back into one preallocated buffer,
+    // e.g. for a single sendmmsg() call: buffers()[i] is the i-th datagram.
+    // Nothing is allocated after construction.
+    class Batch {
+    public:
+        Batch(size_t maxPackets, size_t maxBytes) :
+            storage(std::make_unique<char[]>(maxBytes)),
+            capacityBytes(maxBytes)
+        {
+            packets.reserve(maxPackets);
+        }
+
+        Batch(const Batch &) = delete;
+        Batch(Batch &&) noexcept = default;
+        Batch & operator=(const Batch &) = delete;
+        Batch & operator=(Batch &&) noexcept = default;
+        ~Batch() = default;
+
+        // false if the batch is full
+        bool add(ConnlessType type, std::string_view data) noexcept
+        {
+            if (packets.size() == packets.capacity()) {
+                return false;
+            }
+
+            auto free = Utility::Span<char>(storage.get() + usedBytes, capacityBytes - usedBytes);
+            size_t size = serialize(type, data, free);
+            if (size == 0) {
+                return false;
+            }
+
+            packets.emplace_back(free.data(), size);
+            usedBytes += size;
+            return true;
+        }
+
+        template<ConnlessType Type>
+        bool add(const ConnlessView<Type> & packet) noexcept
+        {
+            return add(Type, packet.data);
+        }
+
+        bool add(const ConnlessPacketView & packet) noexcept
+        {
+            if (getType(packet) == CLS__BAD) {
+                return false;
+            }
+            return add(getType(packet), getData(packet));
+        }
+
+        // Keeps the memory
+        void clear() noexcept
+        {
+            packets.clear();
+            usedBytes = 0;
+        }
+
+        const std::vector<Utility::Span<const char>> & buffers() const & noexcept
+        {
+            return packets;
+        }
+
+        size_t size() const noexcept
+        {
+            return packets.size();
+        }
+
+        bool empty() const noexcept
+        {
+            return packets.empty();
+        }
+
+        size_t bytes() const noexcept
+        {
+            return usedBytes;
+        }
+
+    private:
+        std::unique_ptr<char[]> storage;
+        size_t capacityBytes;
+        size_t usedBytes = 0;
+        std::vector<Utility::Span<const char>> packets{};
+    };
+}
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <boost/asio.hpp>
 
+#include "../ServerAddress.h"
 #include "../jka/JKADefs.h"
 #include "../jka/JKAConstants.h"
 #include "ConnlessPacket.h"
@@ -39,11 +43,12 @@ namespace JKA {
 
         class GetserversResponse : public ConnlessDataPacket {
         public:
-            using ServersVector = std::vector<boost::asio::ip::udp::endpoint>;
+            using ServersVector = std::vector<ServerAddress>;
 
-            GetserversResponse(std::string_view data, ServersVector && servers_) :
+            GetserversResponse(std::string_view data, ServersVector && servers_, bool last_) :
                 ConnlessDataPacket(getStaticType(), data),
-                servers(servers_)
+                servers(std::move(servers_)),
+                last(last_)
             {
             }
 
@@ -59,56 +64,167 @@ namespace JKA {
                 return servers;
             }
 
-            static inline std::unique_ptr<GetserversResponse> parse(std::string_view data)
+            // Ends with EOT. dpmaster ends every datagram of a getservers reply
+            // with it, so this does not mean the list is complete.
+            bool isLast() const noexcept
             {
-                const uint8_t *response = reinterpret_cast<const uint8_t *>(data.data());
-                const uint8_t *responseEnd = response + data.size();
+                return last;
+            }
 
+            static inline std::unique_ptr<GetserversResponse> parse(std::string_view data)
+            {
                 ServersVector servers;
+                servers.reserve(data.size() / ENTRY_SIZE);
+                bool last = parseServers(data, [&servers](const ServerAddress & server) {
+                    servers.push_back(server);
+                });
+
+                return std::make_unique<GetserversResponse>(data, std::move(servers), last);
+            }
 
-                // Original JKA's implementation
-                while (response + 1 < responseEnd) {
-                    boost::asio::ip::address_v4::bytes_type ip = {};
-                    uint16_t port = 0;
-
-                    // advance to initial token
-                    do {
-                        if (*response++ == '\\') {
-                            break;
-                        }
-                    } while (response < responseEnd);
-
-                    if (response >= responseEnd - (ip.size() + sizeof(port))) {
-                        break;
-                    }
-
-                    ip[0] = *response++;
-                    ip[1] = *response++;
-                    ip[2] = *response++;
-                    ip[3] = *response++;
-
-                    // parse out port
-                    port = static_cast<uint16_t>(*response++) << 8;
-                    port |= static_cast<uint16_t>(*response++);
-
-                    // syntax check
-                    if (*response != '\\') {
-                        break;
-                    }
-
-                    servers.emplace_back(boost::asio::ip::address_v4(ip), port);
-
-                    // parse out EOT
-                    if ((responseEnd - response) >= 3 && response[1] == 'E' && response[2] == 'O' && response[3] == 'T') {
-                        break;
-                    }
+            // onServer(const ServerAddress &) for every server listed in data, without allocating.
+            // Returns true if data ends with EOT.
+            template<typename F>
+            static bool parseServers(std::string_view data, F && onServer)
+            {
+                // Original JKA's format: \<ip><port>\<ip><port>...\EOT\0\0\0
+                // The backslash before the first server is the packet's separator,
+                // it has been consumed already. A server is valid if it is followed
+                // by a backslash, so we jump from one to the next.
+                constexpr std::string_view EOT = "EOT";
+
+                size_t idx = 0;
+                while (data.size() - idx >= ENTRY_SIZE && data[idx + ServerAddress::SIZE] == '\\') {
+                    onServer(ServerAddress::fromBytes(data.data() + idx));
+                    idx += ENTRY_SIZE;
                 }
 
-                return std::make_unique<GetserversResponse>(data, std::move(servers));
+                return data.substr(idx, EOT.size()) == EOT;
             }
 
         private:
+            // Address and the backslash after it
+            static constexpr size_t ENTRY_SIZE = ServerAddress::SIZE + 1;
+
             ServersVector servers;
+            bool last = false;
         };
     }
+
+    // Merges the lists of several getserversResponses, e.g. the
+    // packets of a long list or the lists of several masters.
+    // Every server is kept once, in the order they were first listed.
+    class ServerListAccumulator {
+    public:
+        ServerListAccumulator() = default;
+        ServerListAccumulator(const ServerListAccumulator &) = default;
+        ServerListAccumulator(ServerListAccumulator &&) noexcept = default;
+        ServerListAccumulator & operator=(const ServerListAccumulator &) = default;
+        ServerListAccumulator & operator=(ServerListAccumulator &&) noexcept = default;
+        ~ServerListAccumulator() = default;
+
+        // data: of a getserversResponse. Returns the number of new servers.
+        size_t add(std::string_view data)
+        {
+            size_t before = list.size();
+            Packets::GetserversResponse::parseServers(data, [this](const ServerAddress & server) {
+                add(server);
+            });
+            responsesAdded++;
+            return list.size() - before;
+        }
+
+        // false if server is already listed
+        bool add(const ServerAddress & server)
+        {
+            // Keep the load factor below 1/2
+            if ((list.size() + 1) * 2 > keys.size()) {
+                rehash(std::max<size_t>(keys.size() * 2, MIN_BUCKETS));
+            }
+
+            if (!insertKey(server.key())) {
+                return false;
+            }
+            list.push_back(server);
+            return true;
+        }
+
+        bool contains(const ServerAddress & server) const noexcept
+        {
+            if (keys.empty()) {
+                return false;
+            }
+
+            uint64_t stored = server.key() + 1;
+            for (size_t idx = bucket(stored); keys[idx] != EMPTY; idx = (idx + 1) & (keys.size() - 1)) {
+                if (keys[idx] == stored) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        const std::vector<ServerAddress> & servers() const & noexcept
+        {
+            return list;
+        }
+
+        size_t size() const noexcept
+        {
+            return list.size();
+        }
+
+        // The number of getserversResponses added. Nothing in them tells
+        // whether a list is complete: EOT ends every datagram of a dpmaster
+        // list, and the datagrams may come in any order.
+        size_t responses() const noexcept
+        {
+            return responsesAdded;
+        }
+
+        // Keeps the memory
+        void clear() noexcept
+        {
+            list.clear();
+            std::fill(keys.begin(), keys.end(), EMPTY);
+            responsesAdded = 0;
+        }
+
+    private:
+        // Keys are stored + 1, so that 0 marks an empty bucket
+        static constexpr uint64_t EMPTY = 0;
+        static constexpr size_t MIN_BUCKETS = 64;
+
+        size_t bucket(uint64_t stored) const noexcept
+        {
+            // Fibonacci hashing: keys of a list are anything but random
+            return static_cast<size_t>((stored * 0x9E3779B97F4A7C15ull) >> 32) & (keys.size() - 1);
+        }
+
+        bool insertKey(uint64_t key) noexcept
+        {
+            uint64_t stored = key + 1;
+            size_t idx = bucket(stored);
+            while (keys[idx] != EMPTY) {
+                if (keys[idx] == stored) {
+                    return false;
+                }
+                idx = (idx + 1) & (keys.size() - 1);
+            }
+            keys[idx] = stored;
+            return true;
+        }
+
+        void rehash(size_t bucketCount)
+        {
+            keys.assign(bucketCount, EMPTY);
+            for (const auto & server : list) {
+                insertKey(server.key());
+            }
+        }
+
+        std::vector<ServerAddress> list{};
+        std::vector<uint64_t> keys{};  // Open addressing, size is a power of two
+        size_t responsesAdded = 0;
+    };
 }
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <memory>
+
+#include "../jka/JKADefs.h"
+#include "../jka/JKAConstants.h"
+#include "ConnlessPacket.h"
+
+namespace JKA {
+    namespace Packets {
+        // Sent by a server to the masters: "heartbeat QuakeArena-1\n"
+        class Heartbeat : public ConnlessDataPacket {
+        public:
+            static constexpr char DEFAULT_GAME[] = "QuakeArena-1\n";
+
+            Heartbeat(std::string_view data = DEFAULT_GAME) :
+                ConnlessDataPacket(getStaticType(), data)
+            {
+            }
+
+            virtual ~Heartbeat() = default;
+
+            static constexpr ConnlessType getStaticType() noexcept
+            {
+                return CLS_HEARTBEAT;
+            }
+
+            static inline auto parse(std::string_view data)
+            {
+                return std::make_unique<Heartbeat>(data);
+            }
+        };
+    }
+}
@@ -565,7 +565,9 @@ namespace JKA::Protocol {
             writeDeltaKey<8>(key, from->generic_cmd, to->generic_cmd);
         }
 
-        void readDeltaEntity(const entityState_t *from, entityState_t *to, int number) noexcept;
+        // If changedFields is not null, it receives the set of fields present in the delta
+        void readDeltaEntity(const entityState_t *from, entityState_t *to, int number,
+                             EntityFieldMask *changedFields = nullptr) noexcept;
         void writeDeltaEntity(const entityState_t *from, const entityState_t *to, bool force) noexcept;
 
         void readDeltaPlayerstate(const playerState_t *from, playerState_t *to, bool isVehiclePS = false) noexcept;
@@ -1,4 +1,6 @@
 #pragma once
+#include <algorithm>
+
 #include "../SharedDefs.h"
 #include "../utility/Span.h"
 #include "../Huffman.h"
@@ -11,31 +13,22 @@
 namespace JKA::Protocol {
     namespace detail {
         struct BasicEncoder {
-            constexpr static void encode(Utility::Span<ByteType> data,
-                                         Utility::Span<const unsigned char> keyString,
-                                         unsigned char key) noexcept
+            // Every byte is XORed with a running key: the initial key XORed with
+            // the command's chars ('%' read as '.'), shifted left on odd positions.
+            // The command precomputes that sequence (see ReliableCommand::period()).
+            static void encode(Utility::Span<ByteType> data,
+                               const ReliableCommand & command,
+                               unsigned char key) noexcept
             {
-                size_t keyIndex = 0;
-                for (size_t i = 0; i < data.size(); i++) {
-                    unsigned char keyChar = 0;
-                    if (keyIndex >= keyString.size()) {
-                        keyIndex = 0;
-                    }
-
-                    if (keyIndex < keyString.size()) {
-                        // rww: special case for keyString.size() == 0
-                        keyChar = keyString[keyIndex];
-                    }
+                auto period = command.period();
+                unsigned char lapKey = key;
 
-                    if (keyChar == '%') {
-                        key ^= '.' << (i & 1);
-                    } else {
-                        key ^= keyChar << (i & 1);
+                for (size_t offset = 0; offset < data.size(); offset += period.size()) {
+                    size_t count = std::min(period.size(), data.size() - offset);
+                    for (size_t i = 0; i < count; i++) {
+                        data[offset + i] ^= static_cast<ByteType>(lapKey ^ period[i]);
                     }
-
-                    keyIndex++;
-
-                    data[i] ^= key;
+                    lapKey ^= command.lapKey();
                 }
             }
         };
@@ -59,9 +52,8 @@ namespace JKA::Protocol {
 
             int32_t relAck = msg.readLong();
 
-            auto keyString = Utility::Span(store.reliableCommand(relAck));
             unsigned char key = static_cast<unsigned char>(challenge ^ sequence);
-            detail::BasicEncoder::encode(span, keyString, key);
+            detail::BasicEncoder::encode(span, store.reliableCommand(relAck), key);
 
             return PacketType(std::move(data), std::move(msg), sequence, relAck);
         }
@@ -88,11 +80,10 @@ namespace JKA::Protocol {
             int32_t messageAcknowledge = msg.readLong();
             int32_t reliableAcknowledge = msg.readLong();
 
-            auto keyString = Utility::Span(store.serverCommand(reliableAcknowledge));
             // Note: sId and mAck are not unsigned-casted, in accordance with the original
             // JKA code
             auto key = static_cast<unsigned char>(challenge ^ serverId ^ messageAcknowledge);
-            detail::BasicEncoder::encode(span, keyString, key);
+            detail::BasicEncoder::encode(span, store.serverCommand(reliableAcknowledge), key);
 
             return PacketType(std::move(data), std::move(msg),
                               sequence, qport, serverId, messageAcknowledge, reliableAcknowledge);
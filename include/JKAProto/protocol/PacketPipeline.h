@@ -0,0 +1,283 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "../ClientConnection.h"
+#include "../Huffman.h"
+#include "../ReliableCommandsStore.h"
+#include "../SharedDefs.h"
+#include "../utility/MpscQueue.h"
+#include "../utility/SpscQueue.h"
+#include "Netchan.h"
+#include "PacketEncoder.h"
+#include "RawPacket.h"
+
+namespace JKA::Protocol {
+    // Preallocated RawPackets handed out by address, so that the views
+    // decoded from them stay valid while they travel between threads.
+    // acquire() is for a single thread, release() is for any.
+    class PacketPool {
+    public:
+        PacketPool(size_t count, size_t reserveBytes = MAX_MSGLEN) :
+            packets(std::make_unique<RawPacket[]>(count)),
+            freePackets(count)
+        {
+            for (size_t i = 0; i < count; i++) {
+                packets[i].getData().reserve(reserveBytes);
+                freePackets.tryPush(&packets[i]);
+            }
+        }
+
+        PacketPool(const PacketPool &) = delete;
+        PacketPool(PacketPool &&) = delete;
+        PacketPool & operator=(const PacketPool &) = delete;
+        PacketPool & operator=(PacketPool &&) = delete;
+        ~PacketPool() = default;
+
+        // nullptr if all of the packets are in use
+        RawPacket *acquire() noexcept
+        {
+            RawPacket *packet = nullptr;
+            freePackets.tryPop(packet);
+            return packet;
+        }
+
+        void release(RawPacket *packet) noexcept
+        {
+            packet->getData().clear();  // Keeps the capacity
+            freePackets.tryPush(std::move(packet));
+        }
+
+    private:
+        std::unique_ptr<RawPacket[]> packets;
+        Utility::MpscQueue<RawPacket *> freePackets;
+    };
+
+    // Splits the handling of a connection's incoming packets into three stages,
+    // each of which may run on its own thread:
+    //   receive: acquire() a buffer, fill it from the socket, submit() it;
+    //   decode:  decode() runs the netchan (fragments, XOR) on the submitted packets;
+    //   parse:   consume() hands the decoded packets to e.g.
+    //            ServerPacketParser::handleConnfullPacketFromServer.
+    // The stages are connected by bounded lock-free queues. When the parse stage
+    // falls behind, the decode stage stops taking packets, and the receive stage
+    // has to drop them (see Stats) instead of blocking the socket.
+    // The XOR key depends on the challenge and the reliable commands, which the
+    // parse stage (or the client's sender) changes while packets are decoded.
+    // So the decode stage keeps copies of its own, changed by post*() in the
+    // order they are posted: the ones posted before a packet is taken from the
+    // receive stage apply to it. The packets already waiting for the parse
+    // stage keep their keys. JKA only changes the challenge while connecting,
+    // and a reliable command is posted before it is sent, so before any packet
+    // acknowledging it can arrive.
+    template<typename PacketEncoderT>
+    class PacketPipeline {
+    public:
+        using PacketType = typename PacketEncoderT::PacketType;
+
+        // Updated by the stages, readable from any thread
+        struct Stats {
+            std::atomic<uint64_t> received{};
+            std::atomic<uint64_t> droppedNoBuffer{};   // acquire() failed
+            std::atomic<uint64_t> droppedQueueFull{};  // submit() failed
+            std::atomic<uint64_t> decoded{};
+            std::atomic<uint64_t> parsed{};
+        };
+
+        PacketPipeline(size_t poolSize, size_t queueCapacity, size_t keyQueueCapacity = 256) :
+            pool(poolSize),
+            received(queueCapacity),
+            decoded(queueCapacity),
+            keyUpdates(keyQueueCapacity)
+        {
+        }
+
+        PacketPipeline(const PacketPipeline &) = delete;
+        PacketPipeline(PacketPipeline &&) = delete;
+        PacketPipeline & operator=(const PacketPipeline &) = delete;
+        PacketPipeline & operator=(PacketPipeline &&) = delete;
+        ~PacketPipeline() = default;
+
+        // Receive stage. nullptr if all of the buffers are in flight,
+        // the datagram should then be read and discarded.
+        RawPacket *acquire() noexcept
+        {
+            RawPacket *packet = pool.acquire();
+            if (packet == nullptr) JKA_UNLIKELY {
+                stats.droppedNoBuffer.fetch_add(1, std::memory_order_relaxed);
+            }
+            return packet;
+        }
+
+        // Receive stage. Takes the packet back on failure.
+        bool submit(RawPacket *packet, TimePoint arriveTime) noexcept
+        {
+            if (!received.tryPush(Received{ packet, arriveTime })) JKA_UNLIKELY {
+                stats.droppedQueueFull.fetch_add(1, std::memory_order_relaxed);
+                pool.release(packet);
+                return false;
+            }
+
+            stats.received.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // Any thread. The keys of the decode stage, mirroring the changes made to
+        // the parse stage's. false if the decode stage is this far behind, the
+        // update should then be posted again once it has caught up.
+        // ServerPacketParser::reset() / ClientConnection::reset()
+        bool postReset(int32_t challenge)
+        {
+            return postKeyUpdate(KeyUpdate::Kind::RESET, challenge, {});
+        }
+
+        bool postChallenge(int32_t challenge)
+        {
+            return postKeyUpdate(KeyUpdate::Kind::CHALLENGE, challenge, {});
+        }
+
+        // ReliableCommandsStore::setReliableCommand()
+        bool postReliableCommand(int32_t sequence, std::string_view command)
+        {
+            return postKeyUpdate(KeyUpdate::Kind::RELIABLE_COMMAND, sequence, command);
+        }
+
+        // ReliableCommandsStore::setServerCommand()
+        bool postServerCommand(int32_t sequence, std::string_view command)
+        {
+            return postKeyUpdate(KeyUpdate::Kind::SERVER_COMMAND, sequence, command);
+        }
+
+        // Decode stage. Returns the number of packets taken from the receive stage.
+        size_t decode(Netchan<PacketEncoderT> & netchan,
+                      Q3Huffman & huffman,
+                      size_t maxPackets = std::numeric_limits<size_t>::max())
+        {
+            size_t count = 0;
+            Received item{};
+            // Only this stage pushes into decoded, so a free slot stays free
+            while (count < maxPackets && decoded.size() < decoded.capacity()) {
+                // Whatever has been posted before the packet was received
+                applyKeyUpdates();
+                if (!received.tryPop(item)) {
+                    break;
+                }
+                count++;
+
+                auto packet = netchan.processIncomingPacket(*item.packet, huffman, decodeConnection, decodeCommands);
+                if (!packet.has_value()) {
+                    // Duplicate, or a fragment which has been copied into the netchan
+                    pool.release(item.packet);
+                    continue;
+                }
+
+                decoded.tryPush(Decoded{ item.packet, std::move(packet), item.arriveTime });
+                stats.decoded.fetch_add(1, std::memory_order_relaxed);
+            }
+            return count;
+        }
+
+        // Parse stage. handler(PacketType &, TimePoint) is called for every decoded packet,
+        // whose data is valid during the call only. Returns the number of packets handled.
+        template<typename Handler>
+        size_t consume(Handler && handler, size_t maxPackets = std::numeric_limits<size_t>::max())
+        {
+            size_t count = 0;
+            Decoded item{};
+            while (count < maxPackets && decoded.tryPop(item)) {
+                count++;
+
+                handler(*item.packet, item.arriveTime);
+                item.packet.reset();
+                pool.release(item.raw);
+                stats.parsed.fetch_add(1, std::memory_order_relaxed);
+            }
+            return count;
+        }
+
+        // Approximate
+        size_t pendingDecode() const noexcept
+        {
+            return received.size();
+        }
+
+        size_t pendingParse() const noexcept
+        {
+            return decoded.size();
+        }
+
+        const Stats & getStats() const & noexcept
+        {
+            return stats;
+        }
+
+    private:
+        struct Received {
+            RawPacket *packet = nullptr;
+            TimePoint arriveTime{};
+        };
+
+        struct Decoded {
+            RawPacket *raw = nullptr;  // Owns the data packet refers to
+            std::optional<PacketType> packet{};
+            TimePoint arriveTime{};
+        };
+
+        struct KeyUpdate {
+            enum class Kind : uint8_t {
+                RESET,             // value: challenge
+                CHALLENGE,         // value: challenge
+                RELIABLE_COMMAND,  // value: sequence
+                SERVER_COMMAND,    // value: sequence
+            };
+
+            Kind kind = Kind::RESET;
+            int32_t value = 0;
+            std::string command{};
+        };
+
+        bool postKeyUpdate(typename KeyUpdate::Kind kind, int32_t value, std::string_view command)
+        {
+            return keyUpdates.tryPush(KeyUpdate{ kind, value, std::string(command) });
+        }
+
+        void applyKeyUpdates()
+        {
+            KeyUpdate update{};
+            while (keyUpdates.tryPop(update)) {
+                switch (update.kind) {
+                case KeyUpdate::Kind::RESET:
+                    decodeConnection.reset(update.value);
+                    decodeCommands.reset();
+                    break;
+                case KeyUpdate::Kind::CHALLENGE:
+                    decodeConnection.challenge = update.value;
+                    break;
+                case KeyUpdate::Kind::RELIABLE_COMMAND:
+                    decodeCommands.setReliableCommand(update.value, update.command);
+                    break;
+                case KeyUpdate::Kind::SERVER_COMMAND:
+                    decodeCommands.setServerCommand(update.value, update.command);
+                    break;
+                }
+            }
+        }
+
+        PacketPool pool;
+        Utility::SpscQueue<Received> received;
+        Utility::SpscQueue<Decoded> decoded;
+        Stats stats{};
+
+        // Posted from any thread, applied by the decode stage
+        Utility::MpscQueue<KeyUpdate> keyUpdates;
+        // The decode stage's keys
+        ClientConnection decodeConnection{};  // Only the challenge is used
+        ReliableCommandsStore decodeCommands{};
+    };
+}
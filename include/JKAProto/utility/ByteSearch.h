@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace JKA::Utility {
+    namespace detail {
+        constexpr uint64_t SWAR_ONES = 0x0101010101010101ull;
+        constexpr uint64_t SWAR_HIGHS = 0x8080808080808080ull;
+
+        // Non-zero if any byte of word is zero. Only the lowest flagged
+        // byte is exact, higher ones may be false positives.
+        constexpr uint64_t swarHasZero(uint64_t word) noexcept
+        {
+            return (word - SWAR_ONES) & ~word & SWAR_HIGHS;
+        }
+    }
+
+    // The index of the first a or b in str at or after from, npos if there is none.
+    // Compares 8 bytes at a time.
+    inline size_t findEither(std::string_view str, char a, char b, size_t from = 0) noexcept
+    {
+        const uint64_t maskA = detail::SWAR_ONES * static_cast<unsigned char>(a);
+        const uint64_t maskB = detail::SWAR_ONES * static_cast<unsigned char>(b);
+
+        size_t idx = from;
+        for (; idx + sizeof(uint64_t) <= str.size(); idx += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, str.data() + idx, sizeof(word));
+            if (detail::swarHasZero(word ^ maskA) | detail::swarHasZero(word ^ maskB)) {
+                break;  // The match is within these 8 bytes
+            }
+        }
+
+        for (; idx < str.size(); idx++) {
+            if (str[idx] == a || str[idx] == b) {
+                return idx;
+            }
+        }
+        return std::string_view::npos;
+    }
+}
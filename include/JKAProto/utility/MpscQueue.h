@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "SpscQueue.h"
+
+namespace JKA::Utility {
+    // Bounded lock-free multiple producer, single consumer queue.
+    // The capacity is rounded up to a power of two.
+    // Every slot carries a sequence number telling whether it is
+    // ready to be written (== position) or read (== position + 1).
+    template<typename T>
+    class MpscQueue {
+    public:
+        explicit MpscQueue(size_t minCapacity) :
+            mask(roundUp(minCapacity) - 1),
+            slots(std::make_unique<Slot[]>(mask + 1))
+        {
+            for (size_t i = 0; i <= mask; i++) {
+                slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MpscQueue(const MpscQueue &) = delete;
+        MpscQueue(MpscQueue &&) = delete;
+        MpscQueue & operator=(const MpscQueue &) = delete;
+        MpscQueue & operator=(MpscQueue &&) = delete;
+        ~MpscQueue() = default;
+
+        // Any thread. Does not touch value if the queue is full.
+        bool tryPush(T && value) noexcept(std::is_nothrow_move_assignable_v<T>)
+        {
+            size_t pos = tail.load(std::memory_order_relaxed);
+            while (true) {
+                Slot & slot = slots[pos & mask];
+                size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+
+                if (diff == 0) {
+                    // The slot is free, claim it
+                    if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        slot.value = std::move(value);
+                        slot.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;  // Not yet consumed since the last lap
+                } else {
+                    pos = tail.load(std::memory_order_relaxed);  // Claimed by another producer
+                }
+            }
+        }
+
+        // Consumer only
+        bool tryPop(T & out) noexcept(std::is_nothrow_move_assignable_v<T>)
+        {
+            Slot & slot = slots[head & mask];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence != head + 1) {
+                return false;  // Empty, or the producer has not finished writing
+            }
+
+            out = std::move(slot.value);
+            slot.sequence.store(head + mask + 1, std::memory_order_release);
+            head++;
+            return true;
+        }
+
+        size_t capacity() const noexcept
+        {
+            return mask + 1;
+        }
+
+    private:
+        struct Slot {
+            std::atomic<size_t> sequence{};
+            T value{};
+        };
+
+        static size_t roundUp(size_t value) noexcept
+        {
+            size_t capacity = 1;
+            while (capacity < value) {
+                capacity <<= 1;
+            }
+            return capacity;
+        }
+
+        const size_t mask;
+        std::unique_ptr<Slot[]> slots;
+
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail{};
+        alignas(CACHE_LINE_SIZE) size_t head = 0;
+    };
+}
@@ -2,11 +2,14 @@
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <limits>
+#include <memory>
 #include <numeric>
 #include <string>
 #include <string_view>
 #include <type_traits>
 
+#include "../SharedDefs.h"
 #include "Traits.h"
 
 namespace JKA::Utility {
@@ -64,26 +67,26 @@ namespace JKA::Utility {
         {
         }
 
-        template<typename U = value_type, std::enable_if_t<
+        template<typename U = value_type, typename Alloc = std::allocator<U>, std::enable_if_t<
                 std::conjunction_v<
                     std::is_same<U, value_type>,
                     std::is_same<U, typename std::char_traits<U>::char_type>
                 >
             , int> = 0>
-        explicit constexpr Span(std::basic_string<U> & str) : 
+        explicit constexpr Span(std::basic_string<U, std::char_traits<U>, Alloc> & str) : 
             data_ptr(str.data()),
             data_size(str.size())
         {
         }
 
-        template<typename U = value_type, std::enable_if_t<
+        template<typename U = value_type, typename Alloc = std::allocator<U>, std::enable_if_t<
                 std::conjunction_v<
                     std::is_const<element_type>,
                     std::is_same<U, value_type>,
                     std::is_same<U, typename std::char_traits<U>::char_type>
                 >
             , int> = 0>
-        explicit constexpr Span(const std::basic_string<U> & str) : 
+        explicit constexpr Span(const std::basic_string<U, std::char_traits<U>, Alloc> & str) : 
             data_ptr(str.data()),
             data_size(str.size())
         {
@@ -234,15 +237,15 @@ namespace JKA::Utility {
         , int> = 0>
     Span(std::basic_string_view<CharT> sv) -> Span<const CharT>;
 
-    template<typename CharT, std::enable_if_t<
+    template<typename CharT, typename Alloc, std::enable_if_t<
             std::is_same_v<CharT, typename std::char_traits<CharT>::char_type>
         , int> = 0>
-    Span(std::basic_string<CharT> & str) -> Span<CharT>;
+    Span(std::basic_string<CharT, std::char_traits<CharT>, Alloc> & str) -> Span<CharT>;
 
-    template<typename CharT, std::enable_if_t<
+    template<typename CharT, typename Alloc, std::enable_if_t<
             std::is_same_v<CharT, typename std::char_traits<CharT>::char_type>
         , int> = 0>
-    Span(const std::basic_string<CharT> & str) -> Span<const CharT>;
+    Span(const std::basic_string<CharT, std::char_traits<CharT>, Alloc> & str) -> Span<const CharT>;
 
     template<size_t Size, typename CharT>
     Span(const CharT (&arr)[Size]) -> Span<const CharT>;
@@ -0,0 +1,109 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace JKA::Utility {
+    // Not every standard library has std::hardware_destructive_interference_size
+    inline constexpr size_t CACHE_LINE_SIZE = 64;
+
+    // Bounded lock-free single producer, single consumer queue.
+    // The capacity is rounded up to a power of two.
+    // Slots are reused: a popped element is moved out of its slot,
+    // so T's moved-from state is what stays in the queue.
+    template<typename T>
+    class SpscQueue {
+    public:
+        explicit SpscQueue(size_t minCapacity) :
+            mask(roundUp(minCapacity) - 1),
+            slots(std::make_unique<T[]>(mask + 1))
+        {
+        }
+
+        SpscQueue(const SpscQueue &) = delete;
+        SpscQueue(SpscQueue &&) = delete;
+        SpscQueue & operator=(const SpscQueue &) = delete;
+        SpscQueue & operator=(SpscQueue &&) = delete;
+        ~SpscQueue() = default;
+
+        // Producer only. Does not touch value if the queue is full.
+        bool tryPush(T && value) noexcept(std::is_nothrow_move_assignable_v<T>)
+        {
+            size_t tail = producer.tail.load(std::memory_order_relaxed);
+            if (tail - producer.cachedHead > mask) {
+                producer.cachedHead = consumer.head.load(std::memory_order_acquire);
+                if (tail - producer.cachedHead > mask) {
+                    return false;
+                }
+            }
+
+            slots[tail & mask] = std::move(value);
+            producer.tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer only
+        bool tryPop(T & out) noexcept(std::is_nothrow_move_assignable_v<T>)
+        {
+            size_t head = consumer.head.load(std::memory_order_relaxed);
+            if (head == consumer.cachedTail) {
+                consumer.cachedTail = producer.tail.load(std::memory_order_acquire);
+                if (head == consumer.cachedTail) {
+                    return false;
+                }
+            }
+
+            out = std::move(slots[head & mask]);
+            consumer.head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Approximate when called concurrently with push/pop
+        size_t size() const noexcept
+        {
+            size_t tail = producer.tail.load(std::memory_order_acquire);
+            size_t head = consumer.head.load(std::memory_order_acquire);
+            return tail - head;
+        }
+
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        size_t capacity() const noexcept
+        {
+            return mask + 1;
+        }
+
+    private:
+        static size_t roundUp(size_t value) noexcept
+        {
+            size_t capacity = 1;
+            while (capacity < value) {
+                capacity <<= 1;
+            }
+            return capacity;
+        }
+
+        // The indices grow forever and are masked on access.
+        // Each side caches the other's index to touch its cache line less often.
+        struct alignas(CACHE_LINE_SIZE) ProducerSide {
+            std::atomic<size_t> tail{};
+            size_t cachedHead = 0;
+        };
+
+        struct alignas(CACHE_LINE_SIZE) ConsumerSide {
+            std::atomic<size_t> head{};
+            size_t cachedTail = 0;
+        };
+
+        const size_t mask;
+        std::unique_ptr<T[]> slots;
+
+        ProducerSide producer{};
+        ConsumerSide consumer{};
+    };
+}
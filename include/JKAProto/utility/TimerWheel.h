@@ -0,0 +1,105 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "../SharedDefs.h"
+
+namespace JKA::Utility {
+    // Hashed timing wheel: a timer is kept in the slot of its deadline tick
+    // modulo the number of slots, so scheduling is O(1) and advancing costs
+    // one slot per elapsed tick. Timers can't be cancelled, put a generation
+    // into T and ignore the stale ones when they fire.
+    template<typename T>
+    class TimerWheel {
+    public:
+        using Duration = Clock::duration;
+
+        TimerWheel(size_t slotCount, Duration tick_) :
+            slots(slotCount),
+            tick(tick_)
+        {
+        }
+
+        TimerWheel(const TimerWheel &) = default;
+        TimerWheel(TimerWheel &&) noexcept = default;
+        TimerWheel & operator=(const TimerWheel &) = default;
+        TimerWheel & operator=(TimerWheel &&) noexcept = default;
+        ~TimerWheel() = default;
+
+        // Fires on the first advance() past deadline, rounded up to a tick
+        void schedule(TimePoint deadline, T value)
+        {
+            uint64_t deadlineTick = std::max(ceilTick(deadline), currentTick + 1);
+            slots[deadlineTick % slots.size()].push_back(Entry{ deadlineTick, std::move(value) });
+            count++;
+        }
+
+        // onExpired(T &) for every timer due by now. It may schedule new timers.
+        template<typename F>
+        void advance(TimePoint now, F && onExpired)
+        {
+            uint64_t nowTick = floorTick(now);
+            if (nowTick <= currentTick) {
+                return;
+            }
+
+            // Past a full turn, every slot is visited once
+            uint64_t steps = std::min<uint64_t>(nowTick - currentTick, slots.size());
+            for (uint64_t i = 1; i <= steps; i++) {
+                auto & slot = slots[(currentTick + i) % slots.size()];
+                auto expiredBegin = std::partition(slot.begin(), slot.end(), [nowTick](const Entry & entry) {
+                    return entry.tick > nowTick;
+                });
+                std::move(expiredBegin, slot.end(), std::back_inserter(expired));
+                slot.erase(expiredBegin, slot.end());
+            }
+            currentTick = nowTick;
+            count -= expired.size();
+
+            for (auto & entry : expired) {
+                onExpired(entry.value);
+            }
+            expired.clear();
+        }
+
+        size_t size() const noexcept
+        {
+            return count;
+        }
+
+        bool empty() const noexcept
+        {
+            return count == 0;
+        }
+
+    private:
+        struct Entry {
+            uint64_t tick;
+            T value;
+        };
+
+        uint64_t floorTick(TimePoint time) const noexcept
+        {
+            return static_cast<uint64_t>(time.time_since_epoch() / tick);
+        }
+
+        uint64_t ceilTick(TimePoint time) const noexcept
+        {
+            uint64_t result = floorTick(time);
+            if (time.time_since_epoch() % tick != Duration::zero()) {
+                result++;
+            }
+            return result;
+        }
+
+        std::vector<std::vector<Entry>> slots;
+        Duration tick;
+        uint64_t currentTick = 0;
+        size_t count = 0;
+
+        std::vector<Entry> expired{};  // Reused by advance()
+    };
+}
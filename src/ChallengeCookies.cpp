@@ -0,0 +1,141 @@
+#include <JKAProto/ChallengeCookies.h>
+
+#include <charconv>
+#include <random>
+
+#include <JKAProto/packets/ConnlessSerializer.h>
+
+namespace JKA {
+    namespace {
+        constexpr uint64_t rotl(uint64_t x, int b) noexcept
+        {
+            return (x << b) | (x >> (64 - b));
+        }
+
+        // SipHash-2-4 of two 64-bit words
+        uint64_t sipHash(const ChallengeCookies::Secret & key, uint64_t m0, uint64_t m1) noexcept
+        {
+            uint64_t v0 = key[0] ^ 0x736f6d6570736575ull;
+            uint64_t v1 = key[1] ^ 0x646f72616e646f6dull;
+            uint64_t v2 = key[0] ^ 0x6c7967656e657261ull;
+            uint64_t v3 = key[1] ^ 0x7465646279746573ull;
+
+            auto round = [&]() {
+                v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+                v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+                v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+                v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+            };
+            auto compress = [&](uint64_t m) {
+                v3 ^= m;
+                round();
+                round();
+                v0 ^= m;
+            };
+
+            compress(m0);
+            compress(m1);
+            compress(uint64_t{ 16 } << 56);  // Message length, no tail bytes
+
+            v2 ^= 0xff;
+            round();
+            round();
+            round();
+            round();
+            return v0 ^ v1 ^ v2 ^ v3;
+        }
+    }
+
+    ChallengeCookies::ChallengeCookies(const Secret & secret_, Duration bucket_) :
+        secret(secret_),
+        previousSecret(secret_),
+        bucket(bucket_.count() > 0 ? bucket_ : Duration{ 1 })
+    {
+    }
+
+    ChallengeCookies::Secret ChallengeCookies::randomSecret()
+    {
+        std::random_device rd;
+        Secret result{};
+        for (auto & word : result) {
+            word = (static_cast<uint64_t>(rd()) << 32) ^ rd();
+        }
+        return result;
+    }
+
+    void ChallengeCookies::rotate(const Secret & newSecret) noexcept
+    {
+        previousSecret = secret;
+        secret = newSecret;
+        hasPrevious = true;
+    }
+
+    int32_t ChallengeCookies::make(const ServerAddress & from, TimePoint now) const noexcept
+    {
+        return mac(secret, from, bucketOf(now));
+    }
+
+    bool ChallengeCookies::verify(const ServerAddress & from, int32_t challenge, TimePoint now) const noexcept
+    {
+        uint64_t current = bucketOf(now);
+        for (uint64_t bucketIdx : { current, current - 1 }) {
+            if (mac(secret, from, bucketIdx) == challenge) {
+                return true;
+            }
+            if (hasPrevious && mac(previousSecret, from, bucketIdx) == challenge) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ChallengeCookies::verify(const ServerAddress & from, std::string_view challenge, TimePoint now) const noexcept
+    {
+        // Printed with %i
+        int32_t value = 0;
+        auto end = challenge.data() + challenge.size();
+        auto res = std::from_chars(challenge.data(), end, value);
+        if (res.ec != std::errc() || res.ptr != end) {
+            return false;
+        }
+        return verify(from, value, now);
+    }
+
+    size_t ChallengeCookies::respond(const ServerAddress & from, TimePoint now, Utility::Span<char> buffer) const noexcept
+    {
+        char number[16];
+        auto res = std::to_chars(std::begin(number), std::end(number), make(from, now));
+        std::string_view data(number, static_cast<size_t>(res.ptr - number));
+        return Packets::ConnlessSerializer::serialize(CLS_GETCHALLENGE_RESPONSE, data, buffer);
+    }
+
+    std::optional<JKAInfo> ChallengeCookies::acceptConnect(const ServerAddress & from,
+                                                            const Packets::ConnectView & connect,
+                                                            Q3Huffman & huff,
+                                                            TimePoint now) const
+    {
+        // "<userinfo>", compressed
+        std::string userinfo = huff.decompress(connect.data);
+        std::string_view info = userinfo;
+        if (info.size() >= 2 && info.front() == '"' && info.back() == '"') {
+            info = info.substr(1, info.size() - 2);
+        }
+
+        auto result = JKAInfo::fromInfostring(info);
+        if (!verify(from, result.getField("challenge"), now)) {
+            return std::nullopt;
+        }
+        return result;
+    }
+
+    int32_t ChallengeCookies::mac(const Secret & key, const ServerAddress & from, uint64_t bucketIdx) noexcept
+    {
+        return static_cast<int32_t>(sipHash(key, from.key(), bucketIdx));
+    }
+
+    uint64_t ChallengeCookies::bucketOf(TimePoint now) const noexcept
+    {
+        auto sinceEpoch = std::chrono::duration_cast<Duration>(now.time_since_epoch());
+        return static_cast<uint64_t>(sinceEpoch.count() / bucket.count());
+    }
+}
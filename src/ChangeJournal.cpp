@@ -0,0 +1,54 @@
+#include <JKAProto/ChangeJournal.h>
+#include <algorithm>
+
+namespace JKA {
+    ChangeJournal::ChangeJournal(size_t capacity) :
+        records(std::max<size_t>(capacity, 1))
+    {
+    }
+
+    void ChangeJournal::appendGamestate(int32_t messageNum)
+    {
+        append(ChangeRecord::Kind::GAMESTATE, messageNum, 0);
+    }
+
+    void ChangeJournal::appendConfigString(int32_t messageNum, size_t index, std::string_view value)
+    {
+        auto & record = append(ChangeRecord::Kind::CONFIGSTRING, messageNum, static_cast<int32_t>(index));
+        record.text.assign(value);
+    }
+
+    void ChangeJournal::appendEntity(ChangeRecord::Kind kind, int32_t messageNum,
+                                     int32_t entityNum, const EntityFieldMask & changedFields)
+    {
+        auto & record = append(kind, messageNum, entityNum);
+        record.changedFields = changedFields;
+    }
+
+    void ChangeJournal::appendEvent(int32_t messageNum, int32_t entityNum, entity_event_t event, int32_t eventParm)
+    {
+        auto & record = append(ChangeRecord::Kind::EVENT, messageNum, entityNum);
+        record.event = event;
+        record.eventParm = eventParm;
+    }
+
+    void ChangeJournal::appendServerCommand(int32_t messageNum, int32_t commandSequence, std::string_view command)
+    {
+        auto & record = append(ChangeRecord::Kind::SERVER_COMMAND, messageNum, commandSequence);
+        record.text.assign(command);
+    }
+
+    ChangeRecord & ChangeJournal::append(ChangeRecord::Kind kind, int32_t messageNum, int32_t number) noexcept
+    {
+        auto & record = records[nextSequence % records.size()];
+        record.sequence = nextSequence++;
+        record.kind = kind;
+        record.messageNum = messageNum;
+        record.number = number;
+        record.changedFields.reset();
+        record.event = entity_event_t::EV_NONE;
+        record.eventParm = 0;
+        record.text.clear();
+        return record;
+    }
+}
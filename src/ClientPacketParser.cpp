@@ -86,7 +86,7 @@ namespace JKA {
 
         int32_t key = connection.checksumFeed;
         key ^= connection.messageAcknowledge;
-        key ^= Com_HashKey(reliableCommands.reliableCommand(connection.reliableAcknowledge), 32);
+        key ^= reliableCommands.reliableCommand(connection.reliableAcknowledge).hashKey();
 
         oldcmd = &nullcmd;
         for (int32_t i = 0; i < cmdCount; i++) {
@@ -110,6 +110,6 @@ namespace JKA {
     void ClientPacketParser::onClientReliableCommand(int32_t sequence, std::string && command)
     {
         evListener.onClientReliableCommand(sequence, CommandParser::parseCommand(command));
-        reliableCommands.reliableCommand(sequence) = std::move(command);
+        reliableCommands.setReliableCommand(sequence, command);
     }
 }
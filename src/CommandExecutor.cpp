@@ -1,9 +1,10 @@
 #include <JKAProto/CommandExecutor.h>
 
 namespace JKA {
-    CommandExecutor::Command CommandExecutor::parseCommandString(std::string_view commandString)
+    CommandExecutor::Command CommandExecutor::parseCommandString(std::string_view commandString,
+                                                                  std::pmr::memory_resource *resource)
     {
-        return CommandParser::parseCommand(commandString);
+        return CommandParser::parseCommand(commandString, " \r\n", resource);
     }
 
     // TODO: case-insensitive?
@@ -14,7 +15,7 @@ namespace JKA {
 
     bool CommandExecutor::execute(const Command & command)
     {
-        auto it = commands.find(command.name);
+        auto it = commands.find(std::string_view(command.name));
         if (it == commands.end()) {
             return false;
         } else {
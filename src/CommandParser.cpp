@@ -7,13 +7,11 @@
 namespace JKA::CommandParser {
     namespace detail
     {
-        std::string toLower(std::string_view str)
+        void toLower(std::pmr::string & str)
         {
-            auto res = std::string(str);
-            std::transform(std::begin(res), std::end(res), std::begin(res), [](char c) {
+            std::transform(std::begin(str), std::end(str), std::begin(str), [](char c) {
                 return static_cast<char>(static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(c))));
             });
-            return res;
         }
 
         constexpr static std::array TRUE_VALUES_LOWER = {
@@ -28,12 +26,12 @@ namespace JKA::CommandParser {
             std::string_view("no"),
         };
 
-        constexpr static bool isTrueValue(std::string_view value_lower) noexcept
+        static bool isTrueValue(std::string_view value_lower) noexcept
         {
             return std::find(std::begin(TRUE_VALUES_LOWER), std::end(TRUE_VALUES_LOWER), value_lower) != std::end(TRUE_VALUES_LOWER);
         }
 
-        constexpr static bool isFalseValue(std::string_view value_lower) noexcept
+        static bool isFalseValue(std::string_view value_lower) noexcept
         {
             return std::find(std::begin(FALSE_VALUES_LOWER), std::end(FALSE_VALUES_LOWER), value_lower) != std::end(FALSE_VALUES_LOWER);
         }
@@ -44,10 +42,11 @@ namespace JKA::CommandParser {
     {
     }
 
-    Argument::Argument(std::string_view string) :
-        data(string),
-        dataLower(detail::toLower(string))
+    Argument::Argument(std::string_view string, const allocator_type & alloc) :
+        data(string, alloc),
+        dataLower(string, alloc)
     {
+        detail::toLower(dataLower);
         setTypeFlag(ArgType::Str);  // Always have a string value
         parseAsInt();
         parseAsFloat();
@@ -55,7 +54,29 @@ namespace JKA::CommandParser {
         parseAsBoolExt();
     }
 
-    const std::string & Argument::getStr() const
+    Argument::Argument(const Argument & other, const allocator_type & alloc) :
+        type(other.type),
+        data(other.data, alloc),
+        dataLower(other.dataLower, alloc),
+        dataInt(other.dataInt),
+        dataFloat(other.dataFloat),
+        dataBool(other.dataBool),
+        dataBoolExt(other.dataBoolExt)
+    {
+    }
+
+    Argument::Argument(Argument && other, const allocator_type & alloc) :
+        type(other.type),
+        data(std::move(other.data), alloc),
+        dataLower(std::move(other.dataLower), alloc),
+        dataInt(other.dataInt),
+        dataFloat(other.dataFloat),
+        dataBool(other.dataBool),
+        dataBoolExt(other.dataBoolExt)
+    {
+    }
+
+    const std::pmr::string & Argument::getStr() const
     {
         return data;
     }
@@ -254,16 +275,15 @@ namespace JKA::CommandParser {
         return idx;
     }
 
-    void flushToken(Command & cmd, std::ostringstream & token, bool & nameParsed)
+    void flushToken(Command & cmd, std::pmr::string & token, bool & nameParsed)
     {
         if (nameParsed) {
-            cmd.args.emplace_back(token.str());
+            cmd.args.emplace_back(std::string_view(token));
         } else {
-            cmd.name = token.str();
+            cmd.name = token;
             nameParsed = true;
         }
         token.clear();
-        token.str("");
     }
 
     // Checks if there is a comment start at startIdx
@@ -282,11 +302,11 @@ namespace JKA::CommandParser {
         return (startIdx < str.size() && (sepChars.find(str[startIdx]) != sepChars.npos));
     }
 
-    Command parseCommand(std::string_view cmd, std::string_view sepChars)
+    Command parseCommand(std::string_view cmd, std::string_view sepChars, std::pmr::memory_resource *resource)
     {
         bool isInQuote = false;
-        std::ostringstream token{};
-        Command res{};
+        std::pmr::string token(resource);
+        Command res(resource);
         bool nameParsed = false;
 
         size_t idx = advanceToNextToken(cmd, sepChars, 0);
@@ -315,16 +335,15 @@ namespace JKA::CommandParser {
             }
 
             // A normal character (or we are inside a quoted string)
-            token << curChar;
+            token += curChar;
             idx++;
         }
 
-        auto rest = token.str();
-        if (!rest.empty()) {
+        if (!token.empty()) {
             if (nameParsed) {
-                res.args.emplace_back(rest);
+                res.args.emplace_back(std::string_view(token));
             } else {
-                res.name = rest;
+                res.name = token;
             }
         }
 
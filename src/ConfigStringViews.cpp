@@ -0,0 +1,107 @@
+#include <JKAProto/ConfigStringViews.h>
+
+#include <JKAProto/jka/JKAFunctions.h>
+
+namespace JKA {
+    namespace {
+        template<typename F>
+        void withInfo(std::string_view value, const JKAInfo *info, F && f)
+        {
+            if (info != nullptr) {
+                f(*info);
+            } else {
+                f(JKAInfo::fromInfostring(value));
+            }
+        }
+
+        // Keeps the capacity of the strings
+        void clearStrings(ConfigStringViews::Strings & strings) noexcept
+        {
+            for (auto & string : strings) {
+                string.clear();
+            }
+        }
+    }
+
+    ConfigStringViews::Players::Players(std::pmr::memory_resource *resource) :
+        names(MAX_CLIENTS, resource),
+        cleanNames(MAX_CLIENTS, resource),
+        models(MAX_CLIENTS, resource)
+    {
+    }
+
+    ConfigStringViews::ConfigStringViews(std::pmr::memory_resource *resource) :
+        players(resource),
+        serverInfo(resource),
+        systemInfo(resource),
+        models(MAX_MODELS, resource),
+        sounds(MAX_SOUNDS, resource),
+        locations(MAX_LOCATIONS, resource)
+    {
+    }
+
+    void ConfigStringViews::update(size_t index, std::string_view value, const JKAInfo *info)
+    {
+        if (index >= CS_PLAYERS && index < CS_PLAYERS + MAX_CLIENTS) {
+            size_t clientNum = index - CS_PLAYERS;
+            withInfo(value, info, [this, clientNum, &value](const JKAInfo & userinfo) {
+                players.present[clientNum] = !value.empty();
+                players.names[clientNum] = userinfo.getField("n");
+                players.cleanNames[clientNum] = players.names[clientNum];
+                Q_StripColor(players.cleanNames[clientNum]);
+                players.teams[clientNum] = static_cast<team_t>(userinfo.getIntField("t"));
+                players.models[clientNum] = userinfo.getField("model");
+            });
+            playersVersion++;
+        } else if (index >= CS_MODELS && index < CS_MODELS + MAX_MODELS) {
+            models[index - CS_MODELS] = value;
+            tablesVersion++;
+        } else if (index >= CS_SOUNDS && index < CS_SOUNDS + MAX_SOUNDS) {
+            sounds[index - CS_SOUNDS] = value;
+            tablesVersion++;
+        } else if (index >= CS_LOCATIONS && index < CS_LOCATIONS + MAX_LOCATIONS) {
+            locations[index - CS_LOCATIONS] = value;
+            tablesVersion++;
+        } else if (index == CS_SERVERINFO) {
+            withInfo(value, info, [this](const JKAInfo & fields) {
+                serverInfo.hostname = fields.getField("sv_hostname");
+                serverInfo.mapname = fields.getField("mapname");
+                serverInfo.gametype = static_cast<int32_t>(fields.getIntField("g_gametype"));
+                serverInfo.maxClients = static_cast<int32_t>(fields.getIntField("sv_maxclients"));
+                serverInfo.timelimit = static_cast<int32_t>(fields.getIntField("timelimit"));
+                serverInfo.fraglimit = static_cast<int32_t>(fields.getIntField("fraglimit"));
+                serverInfo.capturelimit = static_cast<int32_t>(fields.getIntField("capturelimit"));
+                serverInfo.needPass = fields.getIntField("g_needpass") != 0;
+            });
+            serverInfoVersion++;
+        } else if (index == CS_SYSTEMINFO) {
+            withInfo(value, info, [this](const JKAInfo & fields) {
+                systemInfo.serverId = static_cast<int32_t>(fields.getIntField("sv_serverid"));
+                systemInfo.pure = fields.getIntField("sv_pure") != 0;
+                systemInfo.cheats = fields.getIntField("sv_cheats") != 0;
+                systemInfo.game = fields.getField("fs_game");
+            });
+            systemInfoVersion++;
+        }
+    }
+
+    void ConfigStringViews::clear()
+    {
+        players.present.fill(false);
+        clearStrings(players.names);
+        clearStrings(players.cleanNames);
+        players.teams.fill(TEAM_FREE);
+        clearStrings(players.models);
+        playersVersion++;
+
+        serverInfo = ServerInfo(models.get_allocator().resource());
+        serverInfoVersion++;
+        systemInfo = SystemInfo(models.get_allocator().resource());
+        systemInfoVersion++;
+
+        clearStrings(models);
+        clearStrings(sounds);
+        clearStrings(locations);
+        tablesVersion++;
+    }
+}
@@ -0,0 +1,109 @@
+#include <JKAProto/ConnlessRateLimiter.h>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace JKA {
+    namespace {
+        // splitmix64 finalizer
+        constexpr uint64_t mix(uint64_t x) noexcept
+        {
+            x ^= x >> 30;
+            x *= 0xbf58476d1ce4e5b9ull;
+            x ^= x >> 27;
+            x *= 0x94d049bb133111ebull;
+            x ^= x >> 31;
+            return x;
+        }
+
+        size_t roundUpToPowerOf2(size_t n) noexcept
+        {
+            size_t result = 1;
+            while (result < n) {
+                result <<= 1;
+            }
+            return result;
+        }
+    }
+
+    uint64_t ConnlessRateLimiter::Stats::dropped() const noexcept
+    {
+        uint64_t result = 0;
+        for (size_t type = 0; type < TYPES; type++) {
+            result += droppedBySource[type] + droppedByTotal[type];
+        }
+        return result;
+    }
+
+    ConnlessRateLimiter::ConnlessRateLimiter(const Options & options) :
+        mask(roundUpToPowerOf2(std::max<size_t>(options.slots, 1)) - 1),
+        seed(options.seed),
+        perSource(options.perSource),
+        total(options.total),
+        buckets(ROWS * (mask + 1))
+    {
+    }
+
+    bool ConnlessRateLimiter::allow(const ServerAddress & from, ConnlessType type, TimePoint now) noexcept
+    {
+        size_t typeIdx = std::min<size_t>(type, CLS__BAD);
+        const Budget & sourceBudget = perSource[typeIdx];
+        const Budget & totalBudget = total[typeIdx];
+        auto nowMs = static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count());
+
+        std::array<Bucket *, ROWS> rows{};
+        if (!sourceBudget.unlimited()) {
+            uint64_t hash = mix(from.key() ^ seed ^ (static_cast<uint64_t>(typeIdx) << 48));
+            uint32_t leastUsed = std::numeric_limits<uint32_t>::max();
+            for (size_t row = 0; row < ROWS; row++) {
+                // A different part of the hash for every row
+                size_t slot = static_cast<size_t>(hash >> (row * 64 / ROWS)) & mask;
+                rows[row] = &buckets[row * (mask + 1) + slot];
+                refill(*rows[row], sourceBudget, nowMs);
+                leastUsed = std::min(leastUsed, rows[row]->used);
+            }
+
+            if (leastUsed + TOKEN > capacity(sourceBudget)) {
+                stats.droppedBySource[typeIdx]++;
+                return false;
+            }
+        }
+
+        Bucket & totalBucket = totalBuckets[typeIdx];
+        if (!totalBudget.unlimited()) {
+            refill(totalBucket, totalBudget, nowMs);
+            if (totalBucket.used + TOKEN > capacity(totalBudget)) {
+                stats.droppedByTotal[typeIdx]++;
+                return false;
+            }
+            totalBucket.used += TOKEN;
+        }
+
+        if (!sourceBudget.unlimited()) {
+            uint32_t full = capacity(sourceBudget);
+            for (Bucket *bucket : rows) {
+                bucket->used = std::min(bucket->used + TOKEN, full);
+            }
+        }
+
+        stats.allowed[typeIdx]++;
+        return true;
+    }
+
+    void ConnlessRateLimiter::refill(Bucket & bucket, const Budget & budget, uint32_t nowMs) noexcept
+    {
+        uint32_t elapsedMs = nowMs - bucket.lastMs;
+        bucket.lastMs = nowMs;
+        // rate tokens per second = rate milli-tokens per ms
+        uint64_t refilled = static_cast<uint64_t>(elapsedMs) * budget.rate;
+        bucket.used = (refilled >= bucket.used) ? 0 : bucket.used - static_cast<uint32_t>(refilled);
+    }
+
+    uint32_t ConnlessRateLimiter::capacity(const Budget & budget) noexcept
+    {
+        constexpr uint32_t MAX_BURST = std::numeric_limits<uint32_t>::max() / TOKEN - 1;
+        return std::min(budget.burst, MAX_BURST) * TOKEN;
+    }
+}
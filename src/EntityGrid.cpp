@@ -0,0 +1,127 @@
+#include <JKAProto/EntityGrid.h>
+
+#include <cmath>
+#include <limits>
+
+namespace JKA {
+    EntityGrid::EntityGrid() noexcept
+    {
+        heads.fill(NONE);
+        next.fill(NONE);
+        prev.fill(NONE);
+        cellOf.fill(-1);
+    }
+
+    void EntityGrid::clear() noexcept
+    {
+        heads.fill(NONE);
+        next.fill(NONE);
+        prev.fill(NONE);
+        cellOf.fill(-1);
+        count = 0;
+    }
+
+    void EntityGrid::update(int32_t entityNum, const vec3_t & origin) noexcept
+    {
+        if (entityNum < 0 || entityNum >= MAX_GENTITIES) JKA_UNLIKELY {
+            return;
+        }
+
+        posX[entityNum] = origin[0];
+        posY[entityNum] = origin[1];
+        posZ[entityNum] = origin[2];
+
+        int32_t cell = cellCoord(origin[1]) * CELLS_PER_AXIS + cellCoord(origin[0]);
+        if (cellOf[entityNum] == cell) {
+            return;  // Moved within the same cell
+        }
+
+        if (cellOf[entityNum] >= 0) {
+            unlink(entityNum);
+        } else {
+            count++;
+        }
+        link(entityNum, cell);
+    }
+
+    void EntityGrid::remove(int32_t entityNum) noexcept
+    {
+        if (!contains(entityNum)) {
+            return;
+        }
+
+        unlink(entityNum);
+        count--;
+    }
+
+    int32_t EntityGrid::cellCoord(float coord) noexcept
+    {
+        float cell = std::floor((coord - MIN_WORLD_COORD) / CELL_SIZE);
+        // Also maps NaNs to 0
+        if (!(cell >= 0.0f)) {
+            return 0;
+        }
+        if (cell >= CELLS_PER_AXIS) {
+            return CELLS_PER_AXIS - 1;
+        }
+        return static_cast<int32_t>(cell);
+    }
+
+    float EntityGrid::cellMin(int32_t cell) noexcept
+    {
+        return MIN_WORLD_COORD + cell * CELL_SIZE;
+    }
+
+    float EntityGrid::ringBound(const Vec3 & center, int32_t minX, int32_t minY, int32_t maxX, int32_t maxY) const noexcept
+    {
+        float bound = std::numeric_limits<float>::max();
+
+        // Sides lying on the grid border have nothing behind them
+        if (minX > 0) {
+            bound = std::min(bound, center[0] - cellMin(minX));
+        }
+        if (maxX < CELLS_PER_AXIS - 1) {
+            bound = std::min(bound, cellMin(maxX + 1) - center[0]);
+        }
+        if (minY > 0) {
+            bound = std::min(bound, center[1] - cellMin(minY));
+        }
+        if (maxY < CELLS_PER_AXIS - 1) {
+            bound = std::min(bound, cellMin(maxY + 1) - center[1]);
+        }
+
+        // center may lie outside of the world
+        return std::max(bound, 0.0f);
+    }
+
+    void EntityGrid::link(int32_t entityNum, int32_t cell) noexcept
+    {
+        int16_t num = static_cast<int16_t>(entityNum);
+
+        prev[num] = NONE;
+        next[num] = heads[cell];
+        if (heads[cell] != NONE) {
+            prev[heads[cell]] = num;
+        }
+        heads[cell] = num;
+        cellOf[num] = cell;
+    }
+
+    void EntityGrid::unlink(int32_t entityNum) noexcept
+    {
+        int32_t cell = cellOf[entityNum];
+
+        if (prev[entityNum] != NONE) {
+            next[prev[entityNum]] = next[entityNum];
+        } else {
+            heads[cell] = next[entityNum];
+        }
+        if (next[entityNum] != NONE) {
+            prev[next[entityNum]] = prev[entityNum];
+        }
+
+        prev[entityNum] = NONE;
+        next[entityNum] = NONE;
+        cellOf[entityNum] = -1;
+    }
+}
@@ -0,0 +1,81 @@
+#include <JKAProto/GameStatePublisher.h>
+
+namespace JKA {
+    GameStatePublisher::GameStatePublisher() :
+        slots(std::make_unique<Slot[]>(SLOTS))
+    {
+    }
+
+    bool GameStatePublisher::publish(const ClientGameState & gameState)
+    {
+        int32_t current = latest.load(std::memory_order_relaxed);
+
+        for (size_t i = 0; i < SLOTS; i++) {
+            if (static_cast<int32_t>(i) == current) {
+                continue;  // Leave the latest state to the readers
+            }
+
+            uint32_t expected = 0;
+            if (!slots[i].readers.compare_exchange_strong(expected, WRITING,
+                                                          std::memory_order_acquire,
+                                                          std::memory_order_relaxed)) {
+                continue;  // Held by a reader
+            }
+
+            copyState(slots[i].state, gameState);
+            slots[i].readers.store(0, std::memory_order_release);
+            latest.store(static_cast<int32_t>(i), std::memory_order_release);
+
+            published.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        skipped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    GameStatePublisher::View GameStatePublisher::acquire() const noexcept
+    {
+        while (true) {
+            int32_t index = latest.load(std::memory_order_acquire);
+            if (index < 0) {
+                return View();
+            }
+
+            Slot & slot = slots[index];
+            uint32_t readers = slot.readers.load(std::memory_order_relaxed);
+            while ((readers & WRITING) == 0) {
+                if (slot.readers.compare_exchange_weak(readers, readers + 1,
+                                                       std::memory_order_acquire,
+                                                       std::memory_order_relaxed)) {
+                    // The slot may have been rewritten since latest was loaded,
+                    // but only with a newer complete state
+                    return View(&slot.readers, &slot.state);
+                }
+            }
+            // Being rewritten, a newer state is on its way
+        }
+    }
+
+    void GameStatePublisher::copyState(PublishedGameState & state, const ClientGameState & gameState)
+    {
+        state.serverTime = gameState.serverTime;
+        state.clientNum = gameState.clientNum;
+        state.snapshot = gameState.curSnap();
+
+        state.numEntities = 0;
+        for (uint16_t entityNum : gameState.activeEntities) {
+            state.entities[state.numEntities++] = gameState.currentEntities[entityNum].state;
+        }
+
+        if (configStrings == nullptr || configStringsVersion != gameState.configStringsVersion) {
+            auto copy = std::make_shared<PublishedGameState::ConfigStrings>();
+            for (const auto & [index, value] : gameState.configStrings) {
+                copy->emplace_hint(copy->end(), index, value);
+            }
+            configStrings = std::move(copy);
+            configStringsVersion = gameState.configStringsVersion;
+        }
+        state.configStrings = configStrings;
+    }
+}
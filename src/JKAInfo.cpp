@@ -6,17 +6,38 @@
 #include <sstream>
 
 namespace JKA {
-    JKAInfo::JKAInfo(std::string_view info) :
-        JKAInfo(JKAInfo::fromInfostring(info))
+    JKAInfo::JKAInfo(const allocator_type & alloc) :
+        MapType(alloc)
     {
     }
 
-    JKAInfo JKAInfo::fromInfostring(std::string_view infostring)
+    JKAInfo::JKAInfo(const JKAInfo & other, const allocator_type & alloc) :
+        MapType(other, alloc)
     {
-        auto jkaInfo = JKAInfo();
+    }
+
+    JKAInfo::JKAInfo(JKAInfo && other, const allocator_type & alloc) :
+        MapType(std::move(other), alloc)
+    {
+    }
+
+    JKAInfo::JKAInfo(std::string_view info, const allocator_type & alloc) :
+        MapType(alloc)
+    {
+        assignInfostring(info);
+    }
+
+    JKAInfo JKAInfo::fromInfostring(std::string_view infostring, const allocator_type & alloc)
+    {
+        return JKAInfo(infostring, alloc);
+    }
+
+    void JKAInfo::assignInfostring(std::string_view infostring)
+    {
+        clear();
 
         if (infostring.size() < 2) {
-            return jkaInfo;
+            return;
         }
 
         std::string_view key, value;
@@ -31,11 +52,11 @@ namespace JKA {
             } else {
                 value = infostring.substr(idx, nextBackslash - idx);
                 // Transform the key to the lower-case
-                auto keyStr = std::string(key);
+                auto keyStr = std::pmr::string(key, get_allocator());
                 std::transform(keyStr.begin(), keyStr.end(), keyStr.begin(), [](char c) {
                     return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
                 });
-                jkaInfo[std::move(keyStr)] = value;
+                (*this)[std::move(keyStr)] = value;
             }
 
             isKey = !isKey;
@@ -46,8 +67,6 @@ namespace JKA {
                 idx = nextBackslash + 1;
             }
         }
-
-        return jkaInfo;
     }
 
     std::string JKAInfo::toInfostring() const
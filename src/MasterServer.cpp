@@ -0,0 +1,288 @@
+#include <JKAProto/MasterServer.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+#include <JKAProto/JKAInfo.h>
+#include <JKAProto/packets/ConnlessSerializer.h>
+
+namespace JKA {
+    namespace {
+        constexpr std::string_view EOT{ "EOT\0\0\0", 6 };
+        constexpr size_t ENTRY_SIZE = ServerAddress::SIZE + 1;  // And the backslash after it
+
+        uint32_t secondsOf(TimePoint now) noexcept
+        {
+            return static_cast<uint32_t>(
+                std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count());
+        }
+
+        // Like Q3's Cmd_TokenizeString, without the quotes
+        template<typename F>
+        void forEachToken(std::string_view data, F && onToken)
+        {
+            size_t idx = 0;
+            while (idx < data.size()) {
+                idx = data.find_first_not_of(" \t\n", idx);
+                if (idx == data.npos) {
+                    break;
+                }
+                size_t end = std::min(data.find_first_of(" \t\n", idx), data.size());
+                onToken(data.substr(idx, end - idx));
+                idx = end;
+            }
+        }
+    }
+
+    MasterServer::Filter MasterServer::Filter::parse(std::string_view getserversData) noexcept
+    {
+        Filter filter{};
+        bool first = true;
+        forEachToken(getserversData, [&filter, &first](std::string_view token) {
+            if (first) {
+                first = false;
+                std::from_chars(token.data(), token.data() + token.size(), filter.protocol);
+            } else if (token == "empty") {
+                filter.flags |= EMPTY;
+            } else if (token == "full") {
+                filter.flags |= FULL;
+            }
+        });
+        return filter;
+    }
+
+    MasterServer::MasterServer(Transport & transport_, const ChallengeCookies & cookies_, Options options_) :
+        transport(transport_),
+        cookies(cookies_),
+        options(options_)
+    {
+        // Room for a single server between the header and EOT
+        options.maxDatagram = std::max(options.maxDatagram,
+                                       Packets::ConnlessSerializer::serializedSize(CLS_GETSERVERS_RESPONSE, "")
+                                       + CONNLESS_PACKETS[CLS_GETSERVERS_RESPONSE].separator.size()
+                                       + ENTRY_SIZE + EOT.size());
+    }
+
+    void MasterServer::handlePacket(const ServerAddress & from, const Packets::ConnlessPacketView & packet, TimePoint now)
+    {
+        switch (Packets::getType(packet)) {
+            case CLS_HEARTBEAT:
+            {
+                // Ask the server itself, so that a spoofed heartbeat registers nothing
+                stats.heartbeats++;
+                char challenge[16];
+                auto res = std::to_chars(std::begin(challenge), std::end(challenge), cookies.make(from, now));
+                std::string_view data(challenge, static_cast<size_t>(res.ptr - challenge));
+
+                char datagram[64];
+                size_t size = Packets::ConnlessSerializer::serialize(CLS_GETINFO, data,
+                                                                     Utility::Span<char>(datagram, sizeof(datagram)));
+                transport.send(from, Utility::Span<const char>(datagram, size));
+                stats.datagramsSent++;
+                break;
+            }
+            case CLS_GETINFO_RESPONSE:
+                onInfoResponse(from, Packets::getData(packet), now);
+                break;
+            case CLS_GETSERVERS:
+            {
+                stats.queries++;
+                for (const auto & datagram : responses(Filter::parse(Packets::getData(packet)))) {
+                    transport.send(from, Utility::Span<const char>(datagram.data(), datagram.size()));
+                    stats.datagramsSent++;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    void MasterServer::poll(TimePoint now)
+    {
+        uint32_t nowSec = secondsOf(now);
+        size_t idx = 0;
+        while (idx < slots.size()) {
+            Entry & entry = slots[idx];
+            // Wrapping difference, so that expiresAt can be compared across 2106
+            if (entry.stored != EMPTY && static_cast<int32_t>(nowSec - entry.expiresAt) >= 0) {
+                erase(idx);  // Might move another entry here
+                stats.expired++;
+                continue;
+            }
+            idx++;
+        }
+    }
+
+    const std::vector<std::vector<char>> & MasterServer::responses(const Filter & filter)
+    {
+        // Any protocol number can be asked for
+        if (cache.size() >= MAX_CACHED_FILTERS && cache.find(filter.key()) == cache.end()) {
+            cache.clear();
+        }
+
+        auto & cached = cache[filter.key()];
+        if (cached.generation != generation) {
+            build(filter, cached.datagrams);
+            cached.generation = generation;
+            stats.cacheMisses++;
+        }
+        return cached.datagrams;
+    }
+
+    void MasterServer::onInfoResponse(const ServerAddress & from, std::string_view data, TimePoint now)
+    {
+        auto info = JKAInfo::fromInfostring(data);
+        if (!cookies.verify(from, info.getField("challenge"), now)) {
+            stats.rejected++;
+            return;
+        }
+
+        int64_t clients = info.getIntField("clients");
+        int64_t maxClients = info.getIntField("sv_maxclients");
+        uint8_t flags = 0;
+        if (clients <= 0) {
+            flags |= Filter::EMPTY;
+        }
+        if (clients >= maxClients) {
+            flags |= Filter::FULL;
+        }
+        auto protocol = static_cast<int16_t>(info.getIntField("protocol"));
+
+        uint64_t stored = from.key() + 1;
+        Entry *entry = find(stored);
+        if (entry == nullptr) {
+            if (count >= options.maxServers) {
+                stats.rejected++;
+                return;
+            }
+            entry = insert(stored);
+            entry->protocol = protocol;
+            entry->flags = flags;
+            generation++;
+            stats.registered++;
+        } else if (entry->protocol != protocol || entry->flags != flags) {
+            entry->protocol = protocol;
+            entry->flags = flags;
+            generation++;
+        }
+
+        entry->expiresAt = secondsOf(now) + static_cast<uint32_t>(options.timeout.count());
+    }
+
+    size_t MasterServer::slotOf(uint64_t stored) const noexcept
+    {
+        // Fibonacci hashing, as in ServerListAccumulator
+        return static_cast<size_t>((stored * 0x9E3779B97F4A7C15ull) >> 32) & (slots.size() - 1);
+    }
+
+    MasterServer::Entry *MasterServer::find(uint64_t stored) noexcept
+    {
+        if (slots.empty()) {
+            return nullptr;
+        }
+
+        for (size_t idx = slotOf(stored); slots[idx].stored != EMPTY; idx = (idx + 1) & (slots.size() - 1)) {
+            if (slots[idx].stored == stored) {
+                return &slots[idx];
+            }
+        }
+        return nullptr;
+    }
+
+    MasterServer::Entry *MasterServer::insert(uint64_t stored)
+    {
+        // Keep the load factor below 1/2
+        if ((count + 1) * 2 > slots.size()) {
+            rehash(std::max(slots.size() * 2, MIN_SLOTS));
+        }
+
+        size_t idx = slotOf(stored);
+        while (slots[idx].stored != EMPTY) {
+            idx = (idx + 1) & (slots.size() - 1);
+        }
+        slots[idx] = Entry{};
+        slots[idx].stored = stored;
+        count++;
+        return &slots[idx];
+    }
+
+    void MasterServer::erase(size_t idx) noexcept
+    {
+        // Backward shift: move up the entries which would not be found past the hole
+        size_t mask = slots.size() - 1;
+        size_t hole = idx;
+        size_t next = (hole + 1) & mask;
+        while (slots[next].stored != EMPTY) {
+            size_t home = slotOf(slots[next].stored);
+            // Can the entry at next move into the hole? Only if its home is not in (hole, next]
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                slots[hole] = slots[next];
+                hole = next;
+            }
+            next = (next + 1) & mask;
+        }
+        slots[hole] = Entry{};
+        count--;
+        generation++;
+    }
+
+    void MasterServer::rehash(size_t slotCount)
+    {
+        std::vector<Entry> old = std::move(slots);
+        slots.assign(slotCount, Entry{});
+        for (const auto & entry : old) {
+            if (entry.stored == EMPTY) {
+                continue;
+            }
+            size_t idx = slotOf(entry.stored);
+            while (slots[idx].stored != EMPTY) {
+                idx = (idx + 1) & (slots.size() - 1);
+            }
+            slots[idx] = entry;
+        }
+    }
+
+    void MasterServer::build(const Filter & filter, std::vector<std::vector<char>> & datagrams) const
+    {
+        // <CONNLESS_PREFIX>getserversResponse\<ip><port>\<ip><port>\...\EOT\0\0\0
+        // Only the last datagram ends with EOT
+        const size_t headerSize = Packets::ConnlessSerializer::serializedSize(CLS_GETSERVERS_RESPONSE, "")
+            + CONNLESS_PACKETS[CLS_GETSERVERS_RESPONSE].separator.size();
+        const size_t perDatagram = (options.maxDatagram - headerSize - EOT.size()) / ENTRY_SIZE;
+
+        datagrams.clear();
+        auto startDatagram = [&]() -> std::vector<char> & {
+            auto & datagram = datagrams.emplace_back();
+            datagram.reserve(options.maxDatagram);
+            datagram.insert(datagram.end(), CONNLESS_PREFIX_C, CONNLESS_PREFIX_C + CONNLESS_PREFIX_SIZE);
+            const auto & def = CONNLESS_PACKETS[CLS_GETSERVERS_RESPONSE];
+            datagram.insert(datagram.end(), def.name.begin(), def.name.end());
+            datagram.insert(datagram.end(), def.separator.begin(), def.separator.end());
+            return datagram;
+        };
+
+        std::vector<char> *current = &startDatagram();
+        size_t inCurrent = 0;
+        for (const auto & entry : slots) {
+            if (entry.stored == EMPTY || entry.protocol != filter.protocol
+                || (entry.flags & ~filter.flags) != 0) {
+                continue;
+            }
+
+            if (inCurrent == perDatagram) {
+                current = &startDatagram();
+                inCurrent = 0;
+            }
+
+            ServerAddress address(static_cast<uint32_t>((entry.stored - 1) >> 16),
+                                  static_cast<uint16_t>(entry.stored - 1));
+            current->insert(current->end(), address.bytes.begin(), address.bytes.end());
+            current->push_back('\\');
+            inCurrent++;
+        }
+
+        current->insert(current->end(), EOT.begin(), EOT.end());
+    }
+}
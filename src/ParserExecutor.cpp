@@ -0,0 +1,274 @@
+#include <JKAProto/ParserExecutor.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <new>
+#include <string_view>
+
+#include <JKAProto/packets/ConnlessPacketFactory.h>
+
+namespace JKA {
+    namespace {
+        // Empty polls before going to sleep
+        constexpr size_t IDLE_SPINS = 64;
+        // In case a wakeup is missed anyway
+        constexpr auto IDLE_TIMEOUT = std::chrono::milliseconds(10);
+    }
+
+    ObservedServer::ObservedServer(ClientEventsListener & listener) :
+        listener(listener),
+        parser(listener, reliableCommands, connection, *gameState)
+    {
+    }
+
+    void ObservedServer::handlePacket(Protocol::RawPacket & packet, TimePoint arriveTime, Q3Huffman & huffman)
+    {
+        if (packet.isConnless()) {
+            auto connlessPacket = Packets::ConnlessPacketFactory::parsePacket(std::string_view(packet.getData()));
+            if (connlessPacket) {
+                parser.handleOobPacketFromServer(*connlessPacket);
+            }
+            return;
+        }
+
+        auto serverPacket = netchan.processIncomingPacket(packet, huffman, connection, reliableCommands);
+        if (serverPacket.has_value()) {
+            parser.handleConnfullPacketFromServer(*serverPacket, arriveTime);
+        }
+    }
+
+    void ObservedServer::reset()
+    {
+        connection.reset();
+        reliableCommands.reset();
+        netchan.reset();
+
+        // The game state is the only thing living in memory (commands are
+        // destroyed once executed). Even cleared, its containers keep some of
+        // it, so it is destroyed and rebuilt in place: the parser refers to it.
+        ClientGameState *state = gameState.get();
+        uint64_t configStringsVersion = state->configStringsVersion + 1;
+        std::destroy_at(state);
+        memory.release();
+        new (state) ClientGameState(memory.resource());
+        state->configStringsVersion = configStringsVersion;
+    }
+
+    ParserExecutor::ParserExecutor(size_t workerCount, size_t queueCapacity)
+    {
+        if (workerCount == 0) {
+            workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+
+        workers.reserve(workerCount);
+        for (size_t i = 0; i < workerCount; i++) {
+            workers.push_back(std::make_unique<Worker>(queueCapacity));
+        }
+    }
+
+    ParserExecutor::~ParserExecutor()
+    {
+        stop();
+    }
+
+    void ParserExecutor::start()
+    {
+        if (started) {
+            return;
+        }
+
+        started = true;
+        running.store(true, std::memory_order_release);
+        for (auto & worker : workers) {
+            worker->thread = std::thread([this, &worker = *worker] {
+                run(worker);
+            });
+        }
+    }
+
+    void ParserExecutor::stop()
+    {
+        if (!started) {
+            return;
+        }
+
+        running.store(false, std::memory_order_release);
+        for (auto & worker : workers) {
+            notify(*worker);
+        }
+        for (auto & worker : workers) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+        started = false;
+    }
+
+    ParserExecutor::ConnectionId ParserExecutor::addConnection(std::unique_ptr<ObservedServer> server)
+    {
+        ConnectionId id = nextId++;
+        Worker & worker = *workers[workerOf(id)];
+
+        if (!started) {
+            // No worker thread yet
+            worker.servers.emplace(id, std::move(server));
+            return id;
+        }
+
+        Message message{};
+        message.kind = Message::Kind::ATTACH;
+        message.id = id;
+        message.server = std::move(server);
+        pushControl(worker, std::move(message));
+        return id;
+    }
+
+    void ParserExecutor::removeConnection(ConnectionId id)
+    {
+        Worker & worker = *workers[workerOf(id)];
+
+        if (!started) {
+            worker.servers.erase(id);
+            return;
+        }
+
+        Message message{};
+        message.kind = Message::Kind::DETACH;
+        message.id = id;
+        pushControl(worker, std::move(message));
+    }
+
+    bool ParserExecutor::post(ConnectionId id, Protocol::RawPacket packet, TimePoint arriveTime)
+    {
+        Message message{};
+        message.kind = Message::Kind::PACKET;
+        message.id = id;
+        message.packet = std::move(packet);
+        message.arriveTime = arriveTime;
+        return push(*workers[workerOf(id)], std::move(message));
+    }
+
+    bool ParserExecutor::execute(ConnectionId id, Task task)
+    {
+        Message message{};
+        message.kind = Message::Kind::TASK;
+        message.id = id;
+        message.task = std::move(task);
+        return push(*workers[workerOf(id)], std::move(message));
+    }
+
+    uint64_t ParserExecutor::droppedPackets() const noexcept
+    {
+        uint64_t total = 0;
+        for (auto & worker : workers) {
+            total += worker->dropped.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    uint64_t ParserExecutor::processedPackets() const noexcept
+    {
+        uint64_t total = 0;
+        for (auto & worker : workers) {
+            total += worker->processed.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    void ParserExecutor::run(Worker & worker)
+    {
+        size_t idleSpins = 0;
+        while (true) {
+            if (worker.queue.tryPop(worker.current)) {
+                handle(worker, worker.current);
+                idleSpins = 0;
+                continue;
+            }
+
+            // Nothing is posted after stop(), drain what was posted before it
+            if (!running.load(std::memory_order_acquire)) {
+                if (worker.queue.empty()) {
+                    break;
+                }
+                continue;
+            }
+
+            if (++idleSpins < IDLE_SPINS) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock lock(worker.mutex);
+            worker.sleeping.store(true, std::memory_order_relaxed);
+            // Pairs with the fence in notify(): either the producer sees
+            // the worker sleeping, or the worker sees the new message
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (worker.queue.empty() && running.load(std::memory_order_acquire)) {
+                worker.wakeup.wait_for(lock, IDLE_TIMEOUT);
+            }
+            worker.sleeping.store(false, std::memory_order_relaxed);
+            idleSpins = 0;
+        }
+    }
+
+    void ParserExecutor::handle(Worker & worker, Message & message)
+    {
+        switch (message.kind) {
+        case Message::Kind::PACKET:
+        {
+            auto it = worker.servers.find(message.id);
+            if (it != worker.servers.end()) JKA_LIKELY {
+                it->second->handlePacket(message.packet, message.arriveTime, worker.huffman);
+                worker.processed.fetch_add(1, std::memory_order_relaxed);
+            }
+            break;
+        }
+        case Message::Kind::ATTACH:
+            worker.servers.emplace(message.id, std::move(message.server));
+            break;
+        case Message::Kind::DETACH:
+            worker.servers.erase(message.id);
+            break;
+        case Message::Kind::TASK:
+        {
+            auto it = worker.servers.find(message.id);
+            if (it != worker.servers.end()) {
+                message.task(*it->second);
+            }
+            message.task = nullptr;
+            break;
+        }
+        case Message::Kind::NONE:
+            break;
+        }
+    }
+
+    void ParserExecutor::pushControl(Worker & worker, Message && message)
+    {
+        while (!worker.queue.tryPush(std::move(message))) {
+            notify(worker);
+            std::this_thread::yield();
+        }
+        notify(worker);
+    }
+
+    bool ParserExecutor::push(Worker & worker, Message && message)
+    {
+        if (!worker.queue.tryPush(std::move(message))) JKA_UNLIKELY {
+            worker.dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        notify(worker);
+        return true;
+    }
+
+    void ParserExecutor::notify(Worker & worker)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (worker.sleeping.load(std::memory_order_relaxed)) {
+            std::lock_guard lock(worker.mutex);
+            worker.wakeup.notify_one();
+        }
+    }
+}
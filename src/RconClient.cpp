@@ -0,0 +1,150 @@
+#include <JKAProto/RconClient.h>
+
+#include <JKAProto/packets/ConnlessSerializer.h>
+
+namespace JKA {
+    namespace {
+        constexpr size_t TIMER_SLOTS = 512;
+    }
+
+    RconClient::RconClient(Transport & transport_, Options options_, ResultCallback onResult_) :
+        transport(transport_),
+        options(options_),
+        onResult(std::move(onResult_)),
+        timers(TIMER_SLOTS, TICK)
+    {
+    }
+
+    RconClient::CommandId RconClient::send(const ServerAddress & server,
+                                           std::string_view password,
+                                           std::string_view command,
+                                           TimePoint now)
+    {
+        auto [it, inserted] = serversByAddress.try_emplace(server.key(), static_cast<uint32_t>(servers.size()));
+        if (inserted) {
+            servers.emplace_back().address = server;
+        }
+
+        size_t index = it->second;
+        Server & target = servers[index];
+        if (target.queue.size() >= options.maxQueued) {
+            stats.rejected++;
+            return 0;
+        }
+
+        // "rcon <password> <command>"
+        std::string data;
+        data.reserve(password.size() + 1 + command.size());
+        data += password;
+        data += ' ';
+        data += command;
+
+        Command & queued = target.queue.emplace_back();
+        queued.id = ++lastId;
+        queued.datagram.resize(Packets::ConnlessSerializer::serializedSize(CLS_RCON, data));
+        Packets::ConnlessSerializer::serialize(CLS_RCON, data,
+                                               Utility::Span<char>(queued.datagram.data(), queued.datagram.size()));
+        queued.commandOffset = queued.datagram.size() - command.size();
+        pendingCommands++;
+
+        tryStart(index, now);
+        return queued.id;
+    }
+
+    void RconClient::handlePacket(const ServerAddress & from, const Packets::ConnlessPacketView & packet, TimePoint now)
+    {
+        if (Packets::getType(packet) != CLS_PRINT) {
+            return;
+        }
+
+        auto it = serversByAddress.find(from.key());
+        if (it == serversByAddress.end() || !servers[it->second].busy) {
+            stats.ignored++;
+            return;
+        }
+
+        size_t index = it->second;
+        Server & server = servers[index];
+        if (server.packets == 0) {
+            server.latency = std::chrono::duration_cast<Duration>(now - server.sentAt);
+        }
+        server.output += Packets::getData(packet);
+        server.packets++;
+        stats.prints++;
+
+        // Wait for the rest, if any
+        server.generation++;
+        timers.schedule(now + options.quietTime, Timer{ static_cast<uint32_t>(index), server.generation });
+    }
+
+    void RconClient::poll(TimePoint now)
+    {
+        timers.advance(now, [this, now](const Timer & timer) {
+            Server & server = servers[timer.index];
+            if (server.generation != timer.generation) {
+                return;
+            }
+
+            if (server.busy) {
+                complete(timer.index);
+            }
+            tryStart(timer.index, now);
+        });
+    }
+
+    void RconClient::tryStart(size_t index, TimePoint now)
+    {
+        Server & server = servers[index];
+        if (server.busy || server.queue.empty()) {
+            return;
+        }
+
+        if (now < server.nextSendAt) {
+            timers.schedule(server.nextSendAt, Timer{ static_cast<uint32_t>(index), server.generation });
+            return;
+        }
+
+        const Command & command = server.queue.front();
+        transport.send(server.address, Utility::Span<const char>(command.datagram.data(), command.datagram.size()));
+        stats.sent++;
+
+        server.busy = true;
+        server.generation++;
+        server.sentAt = now;
+        server.nextSendAt = now + options.minInterval;
+        server.output.clear();
+        server.packets = 0;
+        server.latency = Duration{};
+        timers.schedule(now + options.timeout, Timer{ static_cast<uint32_t>(index), server.generation });
+    }
+
+    void RconClient::complete(size_t index)
+    {
+        Server & server = servers[index];
+        Command command = std::move(server.queue.front());
+        server.queue.pop_front();
+        server.busy = false;
+        server.generation++;
+        pendingCommands--;
+
+        stats.completed++;
+        if (server.packets == 0) {
+            stats.timedOut++;
+        }
+
+        Result result{};
+        result.id = command.id;
+        result.server = server.address;
+        result.command = command.datagram.substr(command.commandOffset);
+        result.output = std::move(server.output);
+        result.packets = server.packets;
+        result.latency = server.latency;
+        server.output.clear();
+        server.packets = 0;
+
+        // May send more commands, server must not be used past this point
+        if (onResult) {
+            onResult(std::move(result));
+        }
+    }
+}
@@ -0,0 +1,392 @@
+#include <JKAProto/ServerCrawler.h>
+
+#include <algorithm>
+
+#include <JKAProto/packets/ConnlessPacketFactory.h>
+#include <JKAProto/packets/ConnlessSerializer.h>
+#include <JKAProto/packets/Getservers.h>
+
+namespace JKA {
+    namespace {
+        constexpr size_t TIMER_SLOTS = 1024;
+    }
+
+    ServerCrawler::ServerCrawler(Transport & transport_, Options options_, ResultCallback onResult_) :
+        transport(transport_),
+        options(std::move(options_)),
+        onResult(std::move(onResult_)),
+        timers(TIMER_SLOTS, TICK),
+        tokens(options.sendBurst),
+        rng(std::random_device{}())
+    {
+        masters.reserve(options.masters.size());
+        for (const auto & endpoint : options.masters) {
+            masters.push_back(Master{ endpoint });
+        }
+    }
+
+    void ServerCrawler::start(TimePoint now)
+    {
+        lastRefill = now;
+        for (size_t i = 0; i < masters.size(); i++) {
+            sendMaster(i, now);
+        }
+    }
+
+    void ServerCrawler::addServer(const Endpoint & server)
+    {
+        if (!server.address().is_v4()) {
+            return;
+        }
+
+        auto [it, inserted] = targetsByAddress.try_emplace(toServerAddress(server).key(), static_cast<uint32_t>(targets.size()));
+        if (!inserted) {
+            return;
+        }
+
+        Target & target = targets.emplace_back();
+        target.result.endpoint = server;
+        target.pending = (options.queryInfo ? QUERY_INFO : 0) | (options.queryStatus ? QUERY_STATUS : 0);
+        if (target.pending == 0) {
+            target.finished = true;  // Nothing to ask
+            return;
+        }
+
+        // Echoed back in the "challenge" key of the replies
+        static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+        uint64_t random = rng();
+        for (auto & c : target.challenge) {
+            c = HEX_DIGITS[random & 0xF];
+            random >>= 4;
+        }
+
+        newTargets.push_back(it->second);
+        unfinished++;
+        stats.serversListed++;
+    }
+
+    void ServerCrawler::handlePacket(const Endpoint & from, std::string_view data, TimePoint now)
+    {
+        stats.received++;
+
+        Packets::ConnlessPacketView packet{};
+        if (!Packets::ConnlessPacketFactory::parsePacket(data, packet)) {
+            stats.ignored++;
+            return;
+        }
+
+        switch (Packets::getType(packet)) {
+            case CLS_GETSERVERS_RESPONSE:
+                onServersList(from, Packets::getData(packet), now);
+                break;
+            case CLS_GETINFO_RESPONSE:
+            case CLS_GETSTATUS_RESPONSE:
+                onServerReply(from, Packets::getType(packet), Packets::getData(packet), now);
+                break;
+            default:
+                stats.ignored++;
+                break;
+        }
+    }
+
+    void ServerCrawler::poll(TimePoint now)
+    {
+        timers.advance(now, [this, now](const Timer & timer) {
+            onTimer(timer, now);
+        });
+        flushSends(now);
+    }
+
+    bool ServerCrawler::done() const noexcept
+    {
+        return unfinished == 0 && std::all_of(masters.begin(), masters.end(), [](const Master & master) {
+            return master.finished;
+        });
+    }
+
+    void ServerCrawler::sendMaster(size_t index, TimePoint now)
+    {
+        Master & master = masters[index];
+        master.attempts++;
+        master.generation++;
+        send(master.endpoint, CLS_GETSERVERS, options.getserversArgs);
+        timers.schedule(now + options.masterTimeout, Timer{ static_cast<uint32_t>(index), master.generation, true });
+    }
+
+    void ServerCrawler::sendQueries(size_t index, TimePoint now)
+    {
+        Target & target = targets[index];
+        target.result.attempts++;
+        target.generation++;
+        target.sentAt = now;
+
+        if (target.pending & QUERY_INFO) {
+            send(target.result.endpoint, CLS_GETINFO, challengeOf(target));
+        }
+        if (target.pending & QUERY_STATUS) {
+            send(target.result.endpoint, CLS_GETSTATUS, challengeOf(target));
+        }
+        timers.schedule(now + options.queryTimeout, Timer{ static_cast<uint32_t>(index), target.generation, false });
+    }
+
+    void ServerCrawler::send(const Endpoint & to, ConnlessType type, std::string_view data)
+    {
+        sendBuffer.resize(Packets::ConnlessSerializer::serializedSize(type, data));
+        size_t size = Packets::ConnlessSerializer::serialize(type, data, Utility::Span<char>(sendBuffer.data(), sendBuffer.size()));
+        transport.send(to, Utility::Span<const char>(sendBuffer.data(), size));
+        stats.sent++;
+    }
+
+    void ServerCrawler::flushSends(TimePoint now)
+    {
+        if (options.sendRate != 0) {
+            double elapsed = std::chrono::duration<double>(now - lastRefill).count();
+            tokens = std::min<double>(tokens + std::max(elapsed, 0.0) * options.sendRate, options.sendBurst);
+        }
+        lastRefill = now;
+
+        auto takeTokens = [this](const Target & target) {
+            if (options.sendRate == 0) {
+                return true;
+            }
+
+            double cost = ((target.pending & QUERY_INFO) != 0) + ((target.pending & QUERY_STATUS) != 0);
+            if (tokens < cost) {
+                return false;
+            }
+            tokens -= cost;
+            return true;
+        };
+
+        // Retries first, they are already in flight
+        while (!retries.empty()) {
+            uint32_t index = retries.front();
+            if (targets[index].finished) {
+                retries.pop_front();
+                continue;
+            }
+            if (!takeTokens(targets[index])) {
+                return;
+            }
+            retries.pop_front();
+            sendQueries(index, now);
+        }
+
+        while (!newTargets.empty() && inFlight < options.maxInFlight) {
+            uint32_t index = newTargets.front();
+            if (!takeTokens(targets[index])) {
+                return;
+            }
+            newTargets.pop_front();
+            targets[index].inFlight = true;
+            inFlight++;
+            sendQueries(index, now);
+        }
+    }
+
+    void ServerCrawler::onTimer(const Timer & timer, TimePoint now)
+    {
+        if (timer.master) {
+            Master & master = masters[timer.index];
+            if (master.finished || master.generation != timer.generation) {
+                return;
+            }
+
+            if (!master.answered && master.attempts <= options.retries) {
+                sendMaster(timer.index, now);
+            } else {
+                // Silent, or nothing more of its list for masterTimeout
+                master.finished = true;
+            }
+            return;
+        }
+
+        Target & target = targets[timer.index];
+        if (target.finished || target.generation != timer.generation) {
+            return;
+        }
+
+        if (target.result.attempts <= options.retries) {
+            retries.push_back(timer.index);
+        } else {
+            finish(timer.index);
+        }
+    }
+
+    void ServerCrawler::onServersList(const Endpoint & from, std::string_view data, TimePoint now)
+    {
+        auto master = std::find_if(masters.begin(), masters.end(), [&from](const Master & m) {
+            return m.endpoint == from;
+        });
+        if (master == masters.end() || master->finished) {
+            stats.ignored++;
+            return;
+        }
+
+        if (!master->answered) {
+            master->answered = true;
+            stats.mastersAnswered++;
+        }
+
+        // Lists longer than a datagram come in several packets, in any order.
+        // dpmaster ends every one of them with EOT, so the list is over only
+        // once none has come for masterTimeout.
+        Packets::GetserversResponse::parseServers(data, [this](const ServerAddress & server) {
+            addServer(toEndpoint(server));
+        });
+
+        master->generation++;
+        timers.schedule(now + options.masterTimeout,
+                        Timer{ static_cast<uint32_t>(master - masters.begin()), master->generation, true });
+    }
+
+    void ServerCrawler::onServerReply(const Endpoint & from, ConnlessType type, std::string_view data, TimePoint now)
+    {
+        if (!from.address().is_v4()) {
+            stats.ignored++;
+            return;
+        }
+
+        auto it = targetsByAddress.find(toServerAddress(from).key());
+        if (it == targetsByAddress.end() || targets[it->second].finished) {
+            stats.ignored++;
+            return;
+        }
+
+        size_t index = it->second;
+        Target & target = targets[index];
+        uint8_t query = (type == CLS_GETINFO_RESPONSE) ? QUERY_INFO : QUERY_STATUS;
+        if ((target.pending & query) == 0) {
+            stats.ignored++;  // Duplicate
+            return;
+        }
+
+        bool firstReply = target.result.timedOut();
+        if (query == QUERY_INFO) {
+            JKAInfo info(data);
+            if (info.getField("challenge") != challengeOf(target)) {
+                stats.ignored++;
+                return;
+            }
+            target.result.info = std::move(info);
+            target.result.infoReceived = true;
+        } else {
+            if (!Packets::GetstatusResponse::parseStatus(data, statusView)
+                || statusView.getInfoField("challenge") != challengeOf(target)) {
+                stats.ignored++;
+                return;
+            }
+            target.result.status = ServerStatus(statusView);
+            target.result.statusReceived = true;
+        }
+
+        if (firstReply) {
+            target.result.ping = std::chrono::duration_cast<Duration>(now - target.sentAt);
+        }
+
+        target.pending &= ~query;
+        if (target.pending == 0) {
+            finish(index);
+        }
+    }
+
+    void ServerCrawler::finish(size_t index)
+    {
+        Target & target = targets[index];
+        target.finished = true;
+        target.generation++;
+        if (target.inFlight) {
+            target.inFlight = false;
+            inFlight--;
+        }
+        unfinished--;
+
+        if (target.result.timedOut()) {
+            stats.serversTimedOut++;
+        } else {
+            stats.serversAnswered++;
+        }
+
+        if (onResult) {
+            onResult(target.result);
+        }
+
+        // Only the address is needed from now on, to ignore late replies
+        Endpoint endpoint = target.result.endpoint;
+        target.result = ServerResult{};
+        target.result.endpoint = endpoint;
+    }
+
+    void CrawlResults::add(const ServerCrawler::ServerResult & result)
+    {
+        endpoints.push_back(result.endpoint);
+        flags.push_back((result.infoReceived ? INFO_RECEIVED : 0) | (result.statusReceived ? STATUS_RECEIVED : 0));
+        pings.push_back(static_cast<int32_t>(result.ping.count()));
+        infos.push_back(result.info);
+        statuses.push_back(result.status);
+    }
+
+    void UdpCrawlerTransport::send(const ServerCrawler::Endpoint & to, Utility::Span<const char> datagram)
+    {
+        boost::system::error_code ec;
+        socket.send_to(boost::asio::buffer(datagram.data(), datagram.size()), to, 0, ec);
+        if (ec) {
+            errors++;
+        }
+    }
+
+    void UdpCrawlerTransport::run(boost::asio::io_context & io, ServerCrawler & crawler)
+    {
+        std::array<char, MAX_MSGLEN> buffer{};
+        ServerCrawler::Endpoint from{};
+        boost::asio::steady_timer timer(io);
+        size_t pendingHandlers = 0;  // They refer to the locals
+
+        std::function<void()> receive = [&]() {
+            pendingHandlers++;
+            socket.async_receive_from(boost::asio::buffer(buffer), from,
+                                      [&](const boost::system::error_code & ec, size_t size) {
+                pendingHandlers--;
+                if (ec == boost::asio::error::operation_aborted) {
+                    return;
+                }
+                if (!ec) {
+                    crawler.handlePacket(from, std::string_view(buffer.data(), size), Clock::now());
+                }
+                receive();
+            });
+        };
+
+        std::function<void()> tick = [&]() {
+            crawler.poll(Clock::now());
+            if (crawler.done()) {
+                return;
+            }
+
+            pendingHandlers++;
+            timer.expires_after(ServerCrawler::TICK);
+            timer.async_wait([&](const boost::system::error_code & ec) {
+                pendingHandlers--;
+                if (!ec) {
+                    tick();
+                }
+            });
+        };
+
+        if (io.stopped()) {
+            io.restart();
+        }
+
+        // io may have other work, so it is not run to completion
+        receive();
+        tick();
+        while (!crawler.done() && io.run_one() != 0) {
+        }
+
+        boost::system::error_code ec;
+        socket.cancel(ec);
+        timer.cancel();
+        while (pendingHandlers > 0 && io.run_one() != 0) {
+        }
+    }
+}
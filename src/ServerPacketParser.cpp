@@ -1,10 +1,12 @@
 #include <JKAProto/ServerPacketParser.h>
+#include <algorithm>
+#include <iterator>
 #include <type_traits>
 
 #include <JKAProto/packets/AllConnlessPackets.h>
 
 namespace JKA {
-    Huffman ServerPacketParser::huffman{};
+    thread_local Huffman ServerPacketParser::huffman{};
 
     ServerPacketParser::ServerPacketParser(ClientEventsListener & evListener,
                                            ReliableCommandsStore & reliableCommands,
@@ -16,6 +18,10 @@ namespace JKA {
         gameState(gameState)
     {
         initCommands();
+
+        entityDeltas.added.reserve(MAX_GENTITIES);
+        entityDeltas.changed.reserve(MAX_GENTITIES);
+        entityDeltas.removed.reserve(MAX_GENTITIES);
     }
 
     void ServerPacketParser::handleOobPacketFromServer(const Packets::ConnlessPacket & packet)
@@ -81,6 +87,7 @@ namespace JKA {
 
         connection.lastServerPacketTime = arriveTime;
         connection.serverMessageSequence = packet.sequence;
+        snapshotParsed = false;
 
         auto & message = packet.message;
 
@@ -130,10 +137,57 @@ namespace JKA {
         setConnectionState(CA_CONNECTING);
     }
 
+    void ServerPacketParser::setSnapshotListener(SnapshotEventsListener *listener) noexcept
+    {
+        snapshotListener = listener;
+    }
+
+    void ServerPacketParser::setEntityCallbacksEnabled(bool enabled) noexcept
+    {
+        entityCallbacksEnabled = enabled;
+    }
+
+    void ServerPacketParser::setPublisher(GameStatePublisher *newPublisher) noexcept
+    {
+        publisher = newPublisher;
+    }
+
+    void ServerPacketParser::setJournal(ChangeJournal *newJournal) noexcept
+    {
+        journal = newJournal;
+    }
+
+    void ServerPacketParser::setInterests(const ParserInterests & newInterests)
+    {
+        interests = newInterests;
+    }
+
+    const ParserInterests & ServerPacketParser::getInterests() const & noexcept
+    {
+        return interests;
+    }
+
+    SnapshotDelta ServerPacketParser::lastSnapshotDelta() const noexcept
+    {
+        SnapshotDelta delta{};
+        delta.snapshot = deltaSnapshot;
+        delta.added = Utility::Span<const EntityDelta>(entityDeltas.added.data(), entityDeltas.added.size());
+        delta.changed = Utility::Span<const EntityDelta>(entityDeltas.changed.data(), entityDeltas.changed.size());
+        delta.removed = Utility::Span<const EntityDelta>(entityDeltas.removed.data(), entityDeltas.removed.size());
+        delta.events = lastSnapshotEvents();
+        return delta;
+    }
+
+    Utility::Span<const SnapshotEvent> ServerPacketParser::lastSnapshotEvents() const noexcept
+    {
+        return Utility::Span<const SnapshotEvent>(snapshotEvents.events.data(), snapshotEvents.count);
+    }
+
     void ServerPacketParser::reset(int32_t newChallenge)
     {
         reliableCommands.reset();
         gameState.reset();
+        entityEventStates.fill({});
         connection.reset(newChallenge);
     }
 
@@ -145,8 +199,16 @@ namespace JKA {
 
     void ServerPacketParser::setConfigstring(size_t index, std::string_view newValue)
     {
+        if (!interests.wantsConfigString(index)) {
+            return;
+        }
+
         evListener.onConfigstringChanged(index, gameState.getConfigString(index), newValue);
-        gameState.setConfigString(index, newValue);
+        gameState.setConfigString(index, newValue, interests.wantsConfigStringInfo(index));
+
+        if (journal != nullptr) {
+            journal->appendConfigString(gameState.curSnap().snap.messageNum, index, newValue);
+        }
     }
 
     void ServerPacketParser::clearConfigstrings()
@@ -157,7 +219,7 @@ namespace JKA {
     void ServerPacketParser::onSystemInfoChanged(const JKAInfo & newSysteminfo)
     {
         if (auto it = newSysteminfo.find("sv_serverid"); it != newSysteminfo.end()) {
-            connection.serverId = std::stoi(it->second);
+            connection.serverId = std::stoi(std::string(it->second));
         }
 
         evListener.onSystemInfoChanged(newSysteminfo);
@@ -169,8 +231,8 @@ namespace JKA {
         gameState.info = std::move(newInfo);
 
         try {
-            connection.challenge = static_cast<int32_t>(std::stoi(gameState.info["challenge"]));
-            connection.qport = static_cast<uint16_t>(std::stoul(gameState.info["qport"]));
+            connection.challenge = static_cast<int32_t>(std::stoi(std::string(gameState.info["challenge"])));
+            connection.qport = static_cast<uint16_t>(std::stoul(std::string(gameState.info["qport"])));
         } catch (const std::invalid_argument &) {
         } catch (const std::out_of_range &) {
         }
@@ -186,8 +248,11 @@ namespace JKA {
         }
 
         connection.serverCommandSequence = seq;
-        connection.lastExecutedServerCommand = gameState.curSnap.snap.serverTime;
-        reliableCommands.serverCommand(seq) = command;
+        connection.lastExecutedServerCommand = gameState.curSnap().snap.serverTime;
+        reliableCommands.setServerCommand(seq, command);
+        if (journal != nullptr) {
+            journal->appendServerCommand(gameState.curSnap().snap.messageNum, seq, command);
+        }
         onServerReliableCommand(command);
     }
 
@@ -199,6 +264,10 @@ namespace JKA {
         connection.serverCommandSequence = message.readLong();
         clearConfigstrings();
 
+        if (journal != nullptr) {
+            journal->appendGamestate(gameState.curSnap().snap.messageNum);
+        }
+
         while (true) {
             uint8_t cmd = message.readByte();
 
@@ -245,50 +314,79 @@ namespace JKA {
     void ServerPacketParser::parseSnapshot(Protocol::CompressedMessage & message)
     {
         clSnapshot_t *old = nullptr;
-        Snapshot newSnap = {};
         int32_t oldMessageNum = 0;
 
-        newSnap.arriveTime = connection.lastServerPacketTime;
-        newSnap.snap.serverCommandNum = connection.serverCommandSequence;
-        newSnap.snap.serverTime = message.readLong();
-        newSnap.snap.messageNum = connection.serverMessageSequence;
+        entityDeltas.clear();
+        snapshotEvents.clear();
+
+        int32_t messageNum = connection.serverMessageSequence;
+        int32_t serverTime = message.readLong();
 
-        uint8_t deltaNum = message.readByte();
+        int32_t deltaNum = message.readByte();
         if (!deltaNum) {
-            newSnap.snap.deltaNum = -1;
+            deltaNum = -1;
         } else {
-            newSnap.snap.deltaNum = newSnap.snap.messageNum - deltaNum;
+            deltaNum = messageNum - deltaNum;
         }
-        newSnap.snap.snapFlags = message.readByte();
+        int32_t snapFlags = message.readByte();
 
         // If the frame is delta compressed from data that we
         // no longer have available, we must suck up the rest of
         // the frame, but not use it, then ask for a non-compressed
         // message 
-        if (newSnap.snap.deltaNum <= 0) {
-            newSnap.snap.valid = true; // uncompressed frame
+        bool valid = false;
+        if (deltaNum <= 0) {
+            valid = true; // uncompressed frame
             old = nullptr;
         } else {
-            old = &gameState.snapshots[newSnap.snap.deltaNum & PACKET_MASK].snap;
+            old = &gameState.snapshots[deltaNum & PACKET_MASK].snap;
             if (!old->valid) {
                 // Delta from invalid frame
                 // should never happen
-            } else if (old->messageNum != newSnap.snap.deltaNum) {
+            } else if (old->messageNum != deltaNum) {
                 // The frame that the server did the delta from
                 // is too old, so we can't reconstruct it properly.
             } else if (gameState.parseEntitiesNum - old->parseEntitiesNum > MAX_PARSE_ENTITIES - 128) {
                 // Delta parseEntitiesNum too old
             } else {
-                newSnap.snap.valid = true;  // valid delta parse
+                valid = true;  // valid delta parse
             }
         }
 
+        // rww: the snapshot is decoded in place into its slot of the
+        // backup array. The slot may be the one of the delta frame, so
+        // everything needed from the previous snapshots is read first.
+        const Snapshot & prevSnap = gameState.curSnap();
+        bool prevSnapValid = prevSnap.snap.valid;
+        int32_t prevMessageNum = prevSnap.snap.messageNum;
+
+        Snapshot *slot = &gameState.snapshots[messageNum & PACKET_MASK];
+        if (!valid && slot == &prevSnap) {
+            // PACKET_BACKUP messages later: an invalid frame must not replace
+            // the last valid one, only its entity deltas are needed
+            slot = &scratchSnapshot;
+        }
+        Snapshot & newSnap = *slot;
+        bool prevSnapOverwritten = (&newSnap == &prevSnap);
+        bool hadVehicle = (newSnap.snap.ps.m_iVehicleNum != 0);
+
+        newSnap.arriveTime = connection.lastServerPacketTime;
+        newSnap.snap.valid = false;
+        newSnap.snap.snapFlags = snapFlags;
+        newSnap.snap.serverTime = serverTime;
+        newSnap.snap.messageNum = messageNum;
+        newSnap.snap.deltaNum = deltaNum;
+        newSnap.snap.ping = 0;
+        newSnap.snap.cmdNum = 0;
+        newSnap.snap.serverCommandNum = connection.serverCommandSequence;
+
         // read areamask
         size_t len = message.readByte();
         if (len >= MAX_MAP_AREA_BYTES) {
             len = MAX_MAP_AREA_BYTES - 1;
         }
         message.readData(Utility::Span(newSnap.snap.areamask, len));
+        std::fill(std::begin(newSnap.snap.areamask) + len, std::end(newSnap.snap.areamask), uint8_t{ 0 });
 
         // read playerinfo
         if (old) {
@@ -303,16 +401,38 @@ namespace JKA {
             }
         }
 
+        // vps is kept zeroed while there is no vehicle
+        if (!newSnap.snap.ps.m_iVehicleNum && hadVehicle) {
+            newSnap.snap.vps = {};
+        }
+
         // read packet entities
+        snapshotValid = valid;
         parsePacketEntities(message, old, &newSnap.snap);
 
+        // Same as CG_TransitionPlayerState(): no events on the first
+        // snapshot or after switching to another client
+        if (interests.entityEvents && valid && prevSnapValid && !prevSnapOverwritten
+            && prevSnap.snap.ps.clientNum == newSnap.snap.ps.clientNum) {
+            queuePlayerstateEvents(prevSnap.snap.ps, newSnap.snap.ps, serverTime);
+        }
+
         // Current player's entityState is sent over playerState only
-        BG_PlayerStateToEntityState(newSnap.snap.ps, getEntity(newSnap.snap.ps.clientNum).state);
-        getEntity(newSnap.snap.ps.clientNum).valid = true;
+        if (interests.playerEntity) {
+            BG_PlayerStateToEntityState(newSnap.snap.ps, getEntity(newSnap.snap.ps.clientNum).state);
+            getEntity(newSnap.snap.ps.clientNum).valid = true;
+            gameState.activeEntities.insert(newSnap.snap.ps.clientNum);
+            gameState.entityGrid.update(newSnap.snap.ps.clientNum, newSnap.snap.ps.origin);
+        }
 
         // if not valid, dump the entire thing now that it has
         // been properly read
-        if (!newSnap.snap.valid) {
+        if (!valid) {
+            // The entities have been applied all the same
+            if (journal != nullptr) {
+                journalSnapshotDelta(messageNum);
+            }
+            deliverSnapshotDelta(nullptr);
             return;
         }
 
@@ -320,24 +440,25 @@ namespace JKA {
         // received and this one, so if there was a dropped packet
         // it won't look like something valid to delta from next
         // time we wrap around in the buffer
-        oldMessageNum = gameState.curSnap.snap.messageNum + 1;
+        oldMessageNum = prevMessageNum + 1;
 
-        if (newSnap.snap.messageNum - oldMessageNum >= PACKET_BACKUP) {
-            oldMessageNum = newSnap.snap.messageNum - (PACKET_BACKUP - 1);
+        if (messageNum - oldMessageNum >= PACKET_BACKUP) {
+            oldMessageNum = messageNum - (PACKET_BACKUP - 1);
         }
-        for (; oldMessageNum < newSnap.snap.messageNum; oldMessageNum++) {
+        for (; oldMessageNum < messageNum; oldMessageNum++) {
             gameState.snapshots[oldMessageNum & PACKET_MASK].snap.valid = false;
         }
 
-        // copy to the current good spot
-        gameState.curSnap = newSnap;
-        gameState.curSnap.snap.ping = 999;
+        // the frame is already in the backup array, make it the current one
+        newSnap.snap.valid = true;
+        newSnap.snap.ping = 999;
         // calculate ping time
         // TODO: no ping for now
 
-        // save the frame off in the backup array for later delta comparisons
-        gameState.snapshots[gameState.curSnap.snap.messageNum & PACKET_MASK] = gameState.curSnap;
-        gameState.serverTime = gameState.curSnap.snap.serverTime;
+        gameState.curSnapIndex = messageNum & PACKET_MASK;
+        gameState.serverTime = serverTime;
+
+        deliverSnapshotDelta(&newSnap);
     }
 
     void ServerPacketParser::parseSetGame(Protocol::CompressedMessage & message)
@@ -369,6 +490,16 @@ namespace JKA {
     // TODO: parse if needed, discarding it for now
     void ServerPacketParser::parseRMG(Protocol::CompressedMessage & message)
     {
+        auto readHeightmap = [&](uint16_t size) {
+            if (interests.rmgData) {
+                message.readData(Utility::Span(gameState.compressedHeightmap.data(), size));
+            } else {
+                for (uint16_t i = 0; i < size; i++) {
+                    static_cast<void>(message.readByte());
+                }
+            }
+        };
+
         uint16_t rmgHeightMapSize = message.readUShort();
         if (rmgHeightMapSize == 0) {
             return;
@@ -379,7 +510,7 @@ namespace JKA {
         }
 
         static_cast<void>(message.readBit());  // compression flag
-        message.readData(Utility::Span(gameState.compressedHeightmap.data(), rmgHeightMapSize));
+        readHeightmap(rmgHeightMapSize);
 
         uint16_t size = message.readUShort();
         if (size >= gameState.compressedHeightmap.size()) {
@@ -387,7 +518,7 @@ namespace JKA {
         }
 
         static_cast<void>(message.readBit());  // compression flag
-        message.readData(Utility::Span(gameState.compressedHeightmap.data(), rmgHeightMapSize));
+        readHeightmap(size);
 
         // Read the seed		
         static_cast<void>(message.readLong());
@@ -417,9 +548,13 @@ namespace JKA {
         constexpr int32_t INVALID_NUM = 99999;
 
         int32_t newnum = 0;
-        entityState_t *oldstate = nullptr;
+        const entityState_t *oldstate = nullptr;
         int32_t oldindex = 0, oldnum = 0;
 
+        // oldframe may be the same backup slot as newframe
+        int32_t oldNumEntities = oldframe ? oldframe->numEntities : 0;
+        int32_t oldParseEntitiesNum = oldframe ? oldframe->parseEntitiesNum : 0;
+
         newframe->parseEntitiesNum = gameState.parseEntitiesNum;
         newframe->numEntities = 0;
 
@@ -429,10 +564,10 @@ namespace JKA {
         if (!oldframe) {
             oldnum = INVALID_NUM;
         } else {
-            if (oldindex >= oldframe->numEntities) {
+            if (oldindex >= oldNumEntities) {
                 oldnum = INVALID_NUM;
             } else {
-                oldstate = &parsedEntity(oldframe->parseEntitiesNum, oldindex);
+                oldstate = &parsedEntity(oldParseEntitiesNum, oldindex);
                 oldnum = oldstate->number;
             }
         }
@@ -452,27 +587,27 @@ namespace JKA {
             while (oldnum < newnum) {
                 // one or more entities from the old packet are unchanged
 
-                parseDeltaEntity(message, newframe, oldnum, oldstate, true);
+                keepUnchangedEntity(newframe, oldParseEntitiesNum + oldindex);
 
                 oldindex++;
 
-                if (oldindex >= oldframe->numEntities) {
+                if (oldindex >= oldNumEntities) {
                     oldnum = INVALID_NUM;
                 } else {
-                    oldstate = &parsedEntity(oldframe->parseEntitiesNum, oldindex);
+                    oldstate = &parsedEntity(oldParseEntitiesNum, oldindex);
                     oldnum = oldstate->number;
                 }
             }
             if (oldnum == newnum) {
                 // delta from previous state
-                parseDeltaEntity(message, newframe, newnum, oldstate, false);
+                parseDeltaEntity(message, newframe, newnum, oldstate);
 
                 oldindex++;
 
-                if (oldindex >= oldframe->numEntities) {
+                if (oldindex >= oldNumEntities) {
                     oldnum = INVALID_NUM;
                 } else {
-                    oldstate = &parsedEntity(oldframe->parseEntitiesNum, oldindex);
+                    oldstate = &parsedEntity(oldParseEntitiesNum, oldindex);
                     oldnum = oldstate->number;
                 }
                 continue;
@@ -480,7 +615,7 @@ namespace JKA {
 
             if (oldnum > newnum) {
                 // delta from baseline
-                parseDeltaEntity(message, newframe, newnum, &gameState.entityBaselines[newnum], false);
+                parseDeltaEntity(message, newframe, newnum, &gameState.entityBaselines[newnum]);
                 continue;
             }
 
@@ -489,90 +624,221 @@ namespace JKA {
         // any remaining entities in the old frame are copied over
         while (oldnum != INVALID_NUM) {
             // one or more entities from the old packet are unchanged
-            parseDeltaEntity(message, newframe, oldnum, oldstate, true);
+            keepUnchangedEntity(newframe, oldParseEntitiesNum + oldindex);
 
             oldindex++;
 
-            if (oldindex >= oldframe->numEntities) {
+            if (oldindex >= oldNumEntities) {
                 oldnum = INVALID_NUM;
             } else {
-                oldstate = &parsedEntity(oldframe->parseEntitiesNum, oldindex);
+                oldstate = &parsedEntity(oldParseEntitiesNum, oldindex);
                 oldnum = oldstate->number;
             }
         }
     }
 
-    void ServerPacketParser::parseDeltaEntity(Protocol::CompressedMessage & message, clSnapshot_t* frame, int32_t newnum, entityState_t* old, bool unchanged)
+    void ServerPacketParser::parseDeltaEntity(Protocol::CompressedMessage & message, clSnapshot_t* frame, int32_t newnum, const entityState_t* old)
     {
         // save the parsed entity state into the big circular buffer so
         // it can be used as the source for a later delta
-        entityState_t *state = &parsedEntity(gameState.parseEntitiesNum);
+        entityState_t & state = gameState.parseEntities.scratchState();
 
-        if (unchanged) {
-            *state = *old;
-        } else {
-            message.readDeltaEntity(old, state, newnum);
-        }
+        EntityFieldMask changedFields{};
+        message.readDeltaEntity(old, &state, newnum, &changedFields);
+
+        if (state.number >= (MAX_GENTITIES - 1) || state.number < 0) {
+            if (snapshotValid) {
+                entityEventStates[old->number].present = false;
+            }
 
-        if (state->number >= (MAX_GENTITIES - 1) || state->number < 0) {
             auto & curEnt = gameState.currentEntities[old->number];
             if (curEnt.valid) {  // Don't fire spurious remove-events
+                entityDeltas.removed.push_back({ old->number, {} });
                 onEntityRemoved(curEnt);
             }
             return;  // entity was delta removed
         }
 
+        gameState.parseEntities.commit(gameState.parseEntitiesNum);
         gameState.parseEntitiesNum++;
         frame->numEntities++;
 
-        auto & curEnt = gameState.currentEntities[state->number];
+        if (interests.entityEvents && snapshotValid) {
+            queueEntityEvent(state, frame->serverTime);
+        }
+
+        auto & curEnt = gameState.currentEntities[state.number];
 
-        // Copy only if current centity is not valid OR the entity is changed
-        if (!unchanged) {
-            if (!curEnt.valid) {
-                onEntityAdded(curEnt, *state);
-            } else {
-                onEntityChanged(curEnt, *state);
+        if (!interests.wantsEntityType(state.eType)) {
+            if (curEnt.valid) {  // Changed to a type nobody is interested in
+                entityDeltas.removed.push_back({ state.number, {} });
+                onEntityRemoved(curEnt);
             }
+            return;
+        }
+
+        if (!curEnt.valid) {
+            entityDeltas.added.push_back({ state.number, changedFields });
+            onEntityAdded(curEnt, state, frame->serverTime);
+        } else {
+            entityDeltas.changed.push_back({ state.number, changedFields });
+            onEntityChanged(curEnt, state, frame->serverTime);
         }
     }
 
-    CEntity & ServerPacketParser::getEntity(size_t index) &
+    void ServerPacketParser::keepUnchangedEntity(clSnapshot_t *frame, size_t oldParseNum)
     {
-        return gameState.currentEntities[index];
+        // rww: the new frame refers to the same state instead of copying it
+        gameState.parseEntities.share(gameState.parseEntitiesNum, oldParseNum);
+        gameState.parseEntitiesNum++;
+        frame->numEntities++;
+
+        // Unchanged, but a moving entity is somewhere else now
+        const entityState_t & state = gameState.parseEntities[oldParseNum];
+        if (state.pos.trType != TR_STATIONARY && gameState.currentEntities[state.number].valid) {
+            updateEntityGrid(state, frame->serverTime);
+        }
     }
 
-    const CEntity & ServerPacketParser::getEntity(size_t index) const &
+    CEntity & ServerPacketParser::getEntity(size_t index) &
     {
         return gameState.currentEntities[index];
     }
 
-    entityState_t & ServerPacketParser::parsedEntity(size_t parseNum, size_t index) &
+    const CEntity & ServerPacketParser::getEntity(size_t index) const &
     {
-        return gameState.parseEntities[(parseNum + index) % MAX_PARSE_ENTITIES];
+        return gameState.currentEntities[index];
     }
 
     const JKA::entityState_t & ServerPacketParser::parsedEntity(size_t parseNum, size_t index) const &
     {
-        return gameState.parseEntities[(parseNum + index) % MAX_PARSE_ENTITIES];
+        return gameState.parsedEntity(parseNum, index);
     }
 
     void ServerPacketParser::onEntityRemoved(CEntity & curEnt)
     {
         curEnt.removeEntity();
-        evListener.onEntityRemoved(curEnt);
+        gameState.activeEntities.erase(curEnt.state.number);
+        gameState.entityGrid.remove(curEnt.state.number);
+        if (entityCallbacksEnabled) {
+            evListener.onEntityRemoved(curEnt);
+        }
     }
 
-    void ServerPacketParser::onEntityAdded(CEntity & curEnt, entityState_t & newState)
+    void ServerPacketParser::onEntityAdded(CEntity & curEnt, entityState_t & newState, int32_t serverTime)
     {
         curEnt.addEntity(newState);
-        evListener.onEntityAdded(curEnt, newState);
+        gameState.activeEntities.insert(newState.number);
+        updateEntityGrid(newState, serverTime);
+        if (entityCallbacksEnabled) {
+            evListener.onEntityAdded(curEnt, newState);
+        }
     }
 
-    void ServerPacketParser::onEntityChanged(CEntity & curEnt, entityState_t & newState)
+    void ServerPacketParser::onEntityChanged(CEntity & curEnt, entityState_t & newState, int32_t serverTime)
     {
-        evListener.onEntityChanged(curEnt, newState);
+        if (entityCallbacksEnabled) {
+            evListener.onEntityChanged(curEnt, newState);
+        }
         curEnt.changeEntity(newState);
+        updateEntityGrid(newState, serverTime);
+    }
+
+    void ServerPacketParser::updateEntityGrid(const entityState_t & state, int32_t serverTime)
+    {
+        // trBase is only the origin of stationary entities,
+        // a missile's is where it has been launched from
+        if (state.pos.trType == TR_STATIONARY) {
+            gameState.entityGrid.update(state.number, state.pos.trBase);
+            return;
+        }
+
+        vec3_t origin{};
+        BG_EvaluateTrajectory(state.pos, serverTime, origin);
+        gameState.entityGrid.update(state.number, origin);
+    }
+
+    void ServerPacketParser::queueEntityEvent(const entityState_t & state, int32_t serverTime)
+    {
+        auto & prev = entityEventStates[state.number];
+
+        if (state.eType > ET_EVENTS) {
+            // Event entities fire once, when they appear
+            // (or when their slot is taken by another event)
+            if (!prev.present || prev.eType != state.eType || prev.eventParm != state.eventParm) {
+                auto event = static_cast<entity_event_t>(state.eType - ET_EVENTS);
+                snapshotEvents.push({ state.number, event, state.eventParm, serverTime });
+            }
+        } else if ((state.event & ~EV_EVENT_BITS) != 0) {
+            // Regular entities fire when the event changes, nonce included
+            if (!prev.present || prev.event != state.event) {
+                auto event = static_cast<entity_event_t>(state.event & ~EV_EVENT_BITS);
+                snapshotEvents.push({ state.number, event, state.eventParm, serverTime });
+            }
+        }
+
+        prev.eType = state.eType;
+        prev.event = state.event;
+        prev.eventParm = state.eventParm;
+        prev.present = true;
+    }
+
+    // CG_CheckPlayerstateEvents()
+    void ServerPacketParser::queuePlayerstateEvents(const playerState_t & ops, const playerState_t & ps, int32_t serverTime)
+    {
+        if (ps.externalEvent && ps.externalEvent != ops.externalEvent) {
+            auto event = static_cast<entity_event_t>(ps.externalEvent & ~EV_EVENT_BITS);
+            snapshotEvents.push({ ps.clientNum, event, ps.externalEventParm, serverTime });
+        }
+
+        constexpr int32_t PS_EVENTS = static_cast<int32_t>(MAX_PS_EVENTS);
+        for (int32_t i = ps.eventSequence - PS_EVENTS; i < ps.eventSequence; i++) {
+            int32_t slot = i & (PS_EVENTS - 1);
+            // If we have a new predictable event or the server told us
+            // to play another event instead of a predicted event we already issued
+            if (i >= ops.eventSequence || (i > ops.eventSequence - PS_EVENTS && ps.events[slot] != ops.events[slot])) {
+                auto event = static_cast<entity_event_t>(ps.events[slot] & ~EV_EVENT_BITS);
+                snapshotEvents.push({ ps.clientNum, event, ps.eventParms[slot], serverTime });
+            }
+        }
+    }
+
+    void ServerPacketParser::deliverSnapshotDelta(const Snapshot *snapshot)
+    {
+        deltaSnapshot = snapshot;
+        snapshotParsed = true;
+
+        if (journal != nullptr && snapshot != nullptr) {
+            journalSnapshotDelta(snapshot->snap.messageNum);
+        }
+
+        if (publisher != nullptr && snapshot != nullptr) {
+            publisher->publish(gameState);
+        }
+
+        if (snapshotListener != nullptr) {
+            snapshotListener->onSnapshotParsed(lastSnapshotDelta());
+        }
+    }
+
+    void ServerPacketParser::journalSnapshotDelta(int32_t messageNum)
+    {
+        for (const auto & removed : entityDeltas.removed) {
+            journal->appendEntity(ChangeRecord::Kind::ENTITY_REMOVED, messageNum,
+                                  removed.number, removed.changedFields);
+        }
+        for (const auto & added : entityDeltas.added) {
+            journal->appendEntity(ChangeRecord::Kind::ENTITY_ADDED, messageNum,
+                                  added.number, added.changedFields);
+        }
+        for (const auto & changed : entityDeltas.changed) {
+            journal->appendEntity(ChangeRecord::Kind::ENTITY_CHANGED, messageNum,
+                                  changed.number, changed.changedFields);
+        }
+        for (size_t i = 0; i < snapshotEvents.count; i++) {
+            const auto & event = snapshotEvents.events[i];
+            journal->appendEvent(messageNum, event.entityNum, event.event, event.eventParm);
+        }
     }
 
     void ServerPacketParser::initCommands()
@@ -588,7 +854,7 @@ namespace JKA {
 
     void ServerPacketParser::onServerReliableCommand(std::string_view command)
     {
-        auto commandParsed = executor.parseCommandString(command);
+        auto commandParsed = executor.parseCommandString(command, gameState.resource());
         executor.execute(commandParsed);
         evListener.onServerReliableCommand(commandParsed);
     }
@@ -632,7 +898,11 @@ namespace JKA {
             return;
         }
 
-        setConfigstring(index, cmd.concat(1));
+        if (cmd.args.size() == 2) {
+            setConfigstring(index, cmd.args[1].getStr());  // The usual case, no need to concat
+        } else {
+            setConfigstring(index, cmd.concat(1));
+        }
     }
 
     void ServerPacketParser::cmd_bcs(const Command & cmd)
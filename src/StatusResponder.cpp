@@ -0,0 +1,226 @@
+#include <JKAProto/StatusResponder.h>
+
+#include <cstring>
+
+#include <JKAProto/JKAInfo.h>
+#include <JKAProto/SharedDefs.h>
+
+namespace JKA {
+    namespace {
+        constexpr int GT_DUEL = 3;
+        constexpr int GT_POWERDUEL = 4;
+
+        constexpr std::string_view CHALLENGE_KEY = "\\challenge\\";
+
+        void appendInfoPair(std::string & out, std::string_view key, std::string_view value)
+        {
+            out += '\\';
+            out += key;
+            out += '\\';
+            out += value;
+        }
+
+        std::string_view fieldOr(const JKAInfo & info, std::string_view key, std::string_view defaultValue)
+        {
+            auto value = info.getField(key);
+            return value.empty() ? defaultValue : value;
+        }
+
+        // Info_SetValueForKey() leaves the key out if the value is empty,
+        // and refuses to put these into an infostring
+        bool isValidChallenge(std::string_view challenge) noexcept
+        {
+            return !challenge.empty() && challenge.find_first_of("\\;\"") == challenge.npos;
+        }
+
+        // Cmd_Argv(1) of the request
+        std::string_view requestChallenge(std::string_view data) noexcept
+        {
+            return data.substr(0, data.find(' '));
+        }
+    }
+
+    void StatusResponder::update(const ClientGameState & gameState)
+    {
+        if (updated && gameState.configStringsVersion == configStringsVersion) {
+            return;
+        }
+        updated = true;
+        configStringsVersion = gameState.configStringsVersion;
+
+        auto newServerInfo = gameState.getConfigString(CS_SERVERINFO);
+        if (newServerInfo != serverInfo) {
+            serverInfo = newServerInfo;
+            info.dirty = true;
+            status.dirty = true;
+        }
+
+        for (size_t clientNum = 0; clientNum < players.size(); clientNum++) {
+            Player & player = players[clientNum];
+            auto configString = gameState.getConfigString(CS_PLAYERS + clientNum);
+            if (configString == player.configString) {
+                continue;
+            }
+
+            bool wasPresent = player.present;
+            player.configString = configString;
+            player.present = !configString.empty();
+            if (player.present) {
+                auto playerInfo = JKAInfo::fromInfostring(configString);
+                auto name = playerInfo.getField("n");
+                if (name != player.name) {
+                    player.name = name;
+                    status.dirty = true;
+                }
+            } else {
+                player.name.clear();
+                player.score = 0;
+                player.ping = 0;
+            }
+
+            if (player.present != wasPresent) {
+                info.dirty = true;  // clients
+                status.dirty = true;
+            }
+        }
+    }
+
+    void StatusResponder::setPlayerScore(size_t clientNum, int32_t score, int32_t ping)
+    {
+        if (clientNum >= players.size()) {
+            return;
+        }
+
+        Player & player = players[clientNum];
+        if (player.score != score || player.ping != ping) {
+            player.score = score;
+            player.ping = ping;
+            if (player.present) {
+                status.dirty = true;
+            }
+        }
+    }
+
+    size_t StatusResponder::respond(const Packets::ConnlessPacketView & request, Utility::Span<char> buffer)
+    {
+        switch (Packets::getType(request)) {
+            case CLS_GETINFO:
+                return respondInfo(requestChallenge(Packets::getData(request)), buffer);
+            case CLS_GETSTATUS:
+                return respondStatus(requestChallenge(Packets::getData(request)), buffer);
+            default:
+                return 0;
+        }
+    }
+
+    size_t StatusResponder::respondInfo(std::string_view challenge, Utility::Span<char> buffer)
+    {
+        if (info.dirty) JKA_UNLIKELY {
+            rebuildInfo();
+        }
+        size_t size = write(info, challenge, buffer);
+        stats.replies += (size != 0);
+        return size;
+    }
+
+    size_t StatusResponder::respondStatus(std::string_view challenge, Utility::Span<char> buffer)
+    {
+        if (status.dirty) JKA_UNLIKELY {
+            rebuildStatus();
+        }
+        size_t size = write(status, challenge, buffer);
+        stats.replies += (size != 0);
+        return size;
+    }
+
+    size_t StatusResponder::write(const Prebuilt & reply, std::string_view challenge, Utility::Span<char> buffer) noexcept
+    {
+        const std::string *head = &reply.head;
+        if (!isValidChallenge(challenge)) {
+            head = &reply.headNoChallenge;
+            challenge = {};
+        }
+
+        size_t size = head->size() + challenge.size() + reply.tail.size();
+        if (size > buffer.size()) {
+            return 0;
+        }
+
+        char *out = buffer.data();
+        std::memcpy(out, head->data(), head->size());
+        out += head->size();
+        std::memcpy(out, challenge.data(), challenge.size());
+        out += challenge.size();
+        std::memcpy(out, reply.tail.data(), reply.tail.size());
+        return size;
+    }
+
+    void StatusResponder::rebuildInfo()
+    {
+        // Same keys, in the same order as SVC_Info.
+        // The challenge comes first, so the rest is the tail.
+        auto serverInfoKeys = JKAInfo::fromInfostring(serverInfo);
+        size_t clients = 0;
+        for (const auto & player : players) {
+            clients += player.present;
+        }
+
+        info.headNoChallenge.assign(CONNLESS_PREFIX_S);
+        info.headNoChallenge += CONNLESS_PACKETS[CLS_GETINFO_RESPONSE].name;
+        info.headNoChallenge += CONNLESS_PACKETS[CLS_GETINFO_RESPONSE].separator;
+        info.head.assign(info.headNoChallenge);
+        info.head += CHALLENGE_KEY;
+
+        int64_t gametype = serverInfoKeys.getIntField("g_gametype");
+        bool duel = (gametype == GT_DUEL || gametype == GT_POWERDUEL);
+
+        std::string & tail = info.tail;
+        tail.clear();
+        appendInfoPair(tail, "protocol", PROTOCOL_VERSION_STRING);
+        appendInfoPair(tail, "hostname", serverInfoKeys.getField("sv_hostname"));
+        appendInfoPair(tail, "clients", std::to_string(clients));
+        appendInfoPair(tail, "sv_maxclients", fieldOr(serverInfoKeys, "sv_maxclients", "0"));
+        appendInfoPair(tail, "mapname", serverInfoKeys.getField("mapname"));
+        appendInfoPair(tail, "gametype", std::to_string(gametype));
+        appendInfoPair(tail, "needpass", fieldOr(serverInfoKeys, "g_needpass", "0"));
+        appendInfoPair(tail, "truejedi", fieldOr(serverInfoKeys, "g_jedivmerc", "0"));
+        appendInfoPair(tail, "wdisable", fieldOr(serverInfoKeys, duel ? "g_duelweapondisable" : "g_weapondisable", "0"));
+        appendInfoPair(tail, "fdisable", fieldOr(serverInfoKeys, "g_forcepowerdisable", "0"));
+        auto game = serverInfoKeys.getField("fs_game");
+        if (!game.empty()) {
+            appendInfoPair(tail, "game", game);
+        }
+
+        info.dirty = false;
+        stats.infoRebuilds++;
+    }
+
+    void StatusResponder::rebuildStatus()
+    {
+        // The serverinfo with the challenge set last, then a line per player
+        status.headNoChallenge.assign(CONNLESS_PREFIX_S);
+        status.headNoChallenge += CONNLESS_PACKETS[CLS_GETSTATUS_RESPONSE].name;
+        status.headNoChallenge += CONNLESS_PACKETS[CLS_GETSTATUS_RESPONSE].separator;
+        status.headNoChallenge += serverInfo;
+        status.head.assign(status.headNoChallenge);
+        status.head += CHALLENGE_KEY;
+
+        std::string & tail = status.tail;
+        tail.assign("\n");
+        for (const auto & player : players) {
+            if (!player.present) {
+                continue;
+            }
+
+            tail += std::to_string(player.score);
+            tail += ' ';
+            tail += std::to_string(player.ping);
+            tail += " \"";
+            tail += player.name;
+            tail += "\"\n";
+        }
+
+        status.dirty = false;
+        stats.statusRebuilds++;
+    }
+}
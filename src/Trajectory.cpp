@@ -0,0 +1,264 @@
+#include <JKAProto/Trajectory.h>
+
+#include <algorithm>
+
+#include <JKAProto/jka/JKAFunctions.h>
+
+namespace JKA {
+    // ************************** TrajectoryArrays **************************
+    void TrajectoryArrays::clear() noexcept
+    {
+        count = 0;
+        scalarCount = 0;
+    }
+
+    void TrajectoryArrays::push_back(const trajectory_t & tr) noexcept
+    {
+        if (count >= CAPACITY) JKA_UNLIKELY {
+            return;
+        }
+
+        trType[count] = tr.trType;
+        trTime[count] = tr.trTime;
+        trDuration[count] = tr.trDuration;
+
+        baseX[count] = tr.trBase[0];
+        baseY[count] = tr.trBase[1];
+        baseZ[count] = tr.trBase[2];
+        deltaX[count] = tr.trDelta[0];
+        deltaY[count] = tr.trDelta[1];
+        deltaZ[count] = tr.trDelta[2];
+
+        switch (tr.trType) {
+        case TR_STATIONARY:
+        case TR_INTERPOLATE:
+        case TR_LINEAR:
+        case TR_LINEAR_STOP:
+        case TR_GRAVITY:
+            break;
+        default:
+            scalarIndices[scalarCount++] = static_cast<uint16_t>(count);
+            break;
+        }
+
+        count++;
+    }
+
+    void TrajectoryArrays::evaluate(int32_t atTime, float *outX, float *outY, float *outZ) const noexcept
+    {
+        constexpr float HALF_GRAVITY = 0.5f * DEFAULT_GRAVITY;
+
+        // Branchless BG_EvaluateTrajectory() for the linear types:
+        // result = base + scale * delta - (0, 0, gravity)
+        for (size_t i = 0; i < count; i++) {
+            int32_t type = trType[i];
+            int32_t stopTime = trTime[i] + trDuration[i];
+
+            bool linearStop = (type == TR_LINEAR_STOP);
+            bool moving = (type == TR_LINEAR) | linearStop | (type == TR_GRAVITY);
+
+            int32_t time = (linearStop && atTime > stopTime) ? stopTime : atTime;
+            float deltaTime = static_cast<float>(time - trTime[i]) * 0.001f;  // milliseconds to seconds
+            deltaTime = (linearStop && deltaTime < 0.0f) ? 0.0f : deltaTime;
+
+            float scale = moving ? deltaTime : 0.0f;
+            float gravity = (type == TR_GRAVITY) ? (HALF_GRAVITY * deltaTime * deltaTime) : 0.0f;
+
+            outX[i] = baseX[i] + scale * deltaX[i];
+            outY[i] = baseY[i] + scale * deltaY[i];
+            outZ[i] = baseZ[i] + scale * deltaZ[i] - gravity;
+        }
+
+        for (size_t j = 0; j < scalarCount; j++) {
+            size_t i = scalarIndices[j];
+
+            trajectory_t tr{};
+            tr.trType = static_cast<trType_t>(trType[i]);
+            tr.trTime = trTime[i];
+            tr.trDuration = trDuration[i];
+            tr.trBase[0] = baseX[i];
+            tr.trBase[1] = baseY[i];
+            tr.trBase[2] = baseZ[i];
+            tr.trDelta[0] = deltaX[i];
+            tr.trDelta[1] = deltaY[i];
+            tr.trDelta[2] = deltaZ[i];
+
+            vec3_t result{};
+            BG_EvaluateTrajectory(tr, atTime, result);
+            outX[i] = result[0];
+            outY[i] = result[1];
+            outZ[i] = result[2];
+        }
+    }
+
+    // ************************** EntityTrajectories **************************
+    EntityTrajectories::EntityTrajectories() noexcept
+    {
+        indices.fill(-1);
+    }
+
+    void EntityTrajectories::clear() noexcept
+    {
+        for (size_t i = 0; i < size(); i++) {
+            indices[numbers[i]] = -1;
+        }
+
+        pos.clear();
+        apos.clear();
+    }
+
+    void EntityTrajectories::add(const entityState_t & state) noexcept
+    {
+        if (state.number < 0 || state.number >= MAX_GENTITIES) JKA_UNLIKELY {
+            return;
+        }
+
+        if (indices[state.number] >= 0 || size() >= MAX_GENTITIES) JKA_UNLIKELY {
+            return;  // Already added
+        }
+
+        indices[state.number] = static_cast<int16_t>(size());
+        numbers[size()] = state.number;
+        pos.push_back(state.pos);
+        apos.push_back(state.apos);
+    }
+
+    void EntityTrajectories::loadCurrentEntities(const ClientGameState & gameState) noexcept
+    {
+        clear();
+
+        for (auto entityNum : gameState.activeEntities) {
+            add(gameState.currentEntities[entityNum].state);
+        }
+    }
+
+    void EntityTrajectories::loadSnapshot(const ClientGameState & gameState, const Snapshot & snapshot) noexcept
+    {
+        clear();
+
+        const auto & snap = snapshot.snap;
+        for (int32_t i = 0; i < snap.numEntities; i++) {
+            add(gameState.parsedEntity(snap.parseEntitiesNum, i));
+        }
+
+        addPlayer(snap.ps);
+    }
+
+    size_t EntityTrajectories::indexOf(int32_t entityNum) const noexcept
+    {
+        if (entityNum < 0 || entityNum >= MAX_GENTITIES || indices[entityNum] < 0) {
+            return NPOS;
+        }
+
+        return static_cast<size_t>(indices[entityNum]);
+    }
+
+    void EntityTrajectories::evaluate(int32_t atTime, EntityPositions & out) const noexcept
+    {
+        out.count = size();
+        std::copy_n(numbers.begin(), size(), out.number.begin());
+
+        pos.evaluate(atTime, out.originX.data(), out.originY.data(), out.originZ.data());
+        apos.evaluate(atTime, out.pitch.data(), out.yaw.data(), out.roll.data());
+    }
+
+    // Same as the trajectories BG_PlayerStateToEntityState() produces
+    void EntityTrajectories::addPlayer(const playerState_t & ps) noexcept
+    {
+        entityState_t state{};
+        state.number = ps.clientNum;
+
+        state.pos.trType = TR_INTERPOLATE;
+        VectorCopy(ps.origin, state.pos.trBase);
+        VectorCopy(ps.velocity, state.pos.trDelta);
+
+        state.apos.trType = TR_INTERPOLATE;
+        VectorCopy(ps.viewangles, state.apos.trBase);
+
+        add(state);
+    }
+
+    // ************************** EntityInterpolator **************************
+    void EntityInterpolator::setSnapshots(const ClientGameState & gameState,
+                                          const Snapshot & from,
+                                          const Snapshot & to) noexcept
+    {
+        fromTime = from.snap.serverTime;
+        toTime = to.snap.serverTime;
+
+        current.loadSnapshot(gameState, from);
+        next.loadSnapshot(gameState, to);
+        next.evaluate(toTime, scratch);
+
+        // Only TR_INTERPOLATE entities present in both snapshots and
+        // not teleported in between are interpolated
+        std::array<int32_t, MAX_GENTITIES> toFlags{};
+        toFlags[to.snap.ps.clientNum] = to.snap.ps.eFlags;
+        for (int32_t i = 0; i < to.snap.numEntities; i++) {
+            const auto & state = gameState.parsedEntity(to.snap.parseEntitiesNum, i);
+            toFlags[state.number] = state.eFlags;
+        }
+
+        lerp.fill(0.0f);
+        auto setLerp = [&](int32_t entityNum, int32_t fromFlags, int32_t fromTrType) {
+            size_t idx = current.indexOf(entityNum);
+            size_t nextIdx = next.indexOf(entityNum);
+
+            if (idx == EntityTrajectories::NPOS || nextIdx == EntityTrajectories::NPOS) {
+                return;
+            }
+
+            if (fromTrType != TR_INTERPOLATE || ((fromFlags ^ toFlags[entityNum]) & EF_TELEPORT_BIT)) {
+                return;
+            }
+
+            lerp[idx] = 1.0f;
+            nextPositions.originX[idx] = scratch.originX[nextIdx];
+            nextPositions.originY[idx] = scratch.originY[nextIdx];
+            nextPositions.originZ[idx] = scratch.originZ[nextIdx];
+            nextPositions.pitch[idx] = scratch.pitch[nextIdx];
+            nextPositions.yaw[idx] = scratch.yaw[nextIdx];
+            nextPositions.roll[idx] = scratch.roll[nextIdx];
+        };
+
+        for (int32_t i = 0; i < from.snap.numEntities; i++) {
+            const auto & state = gameState.parsedEntity(from.snap.parseEntitiesNum, i);
+            setLerp(state.number, state.eFlags, state.pos.trType);
+        }
+        setLerp(from.snap.ps.clientNum, from.snap.ps.eFlags, TR_INTERPOLATE);
+    }
+
+    void EntityInterpolator::evaluate(int32_t atTime, EntityPositions & out) const noexcept
+    {
+        current.evaluate(atTime, out);
+
+        float frac = 0.0f;
+        if (toTime > fromTime) {
+            frac = static_cast<float>(atTime - fromTime) / static_cast<float>(toTime - fromTime);
+        }
+
+        auto lerpAxis = [this, frac](float *axis, const float *nextAxis, size_t count) noexcept {
+            for (size_t i = 0; i < count; i++) {
+                axis[i] += lerp[i] * frac * (nextAxis[i] - axis[i]);
+            }
+        };
+
+        // LerpAngle(), branchless
+        auto lerpAngle = [this, frac](float *axis, const float *nextAxis, size_t count) noexcept {
+            for (size_t i = 0; i < count; i++) {
+                float delta = nextAxis[i] - axis[i];
+                delta -= (delta > 180.0f) ? 360.0f : 0.0f;
+                delta += (delta < -180.0f) ? 360.0f : 0.0f;
+                axis[i] += lerp[i] * frac * delta;
+            }
+        };
+
+        lerpAxis(out.originX.data(), nextPositions.originX.data(), out.count);
+        lerpAxis(out.originY.data(), nextPositions.originY.data(), out.count);
+        lerpAxis(out.originZ.data(), nextPositions.originZ.data(), out.count);
+
+        lerpAngle(out.pitch.data(), nextPositions.pitch.data(), out.count);
+        lerpAngle(out.yaw.data(), nextPositions.yaw.data(), out.count);
+        lerpAngle(out.roll.data(), nextPositions.roll.data(), out.count);
+    }
+}
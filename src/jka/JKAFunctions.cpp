@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <cstdarg>
 
@@ -25,6 +26,30 @@ namespace JKA
         return hash;
     }
 
+    size_t Q_StripColor(char *text, size_t length) noexcept
+    {
+        auto isColorString = [text, &length](size_t idx) {
+            return text[idx] == Q_COLOR_ESCAPE && idx + 1 < length
+                && text[idx + 1] >= '0' && text[idx + 1] <= '9';
+        };
+
+        bool doPass = true;
+        while (doPass) {
+            doPass = false;
+            size_t write = 0;
+            for (size_t read = 0; read < length; read++) {
+                if (isColorString(read)) {
+                    doPass = true;
+                    read++;
+                    continue;
+                }
+                text[write++] = text[read];
+            }
+            length = write;
+        }
+        return length;
+    }
+
     void BG_PlayerStateToEntityState(playerState_t & ps, entityState_t & s)
     {
         int        i;
@@ -160,4 +185,71 @@ namespace JKA
 
         s.m_iVehicleNum = ps.m_iVehicleNum;
     }
+
+    void BG_EvaluateTrajectory(const trajectory_t & tr, int32_t atTime, vec3_t & result)
+    {
+        constexpr float PI = 3.14159265358979323846f;
+
+        float deltaTime = 0.0f;
+        float phase = 0.0f;
+
+        switch (tr.trType) {
+        case TR_STATIONARY:
+        case TR_INTERPOLATE:
+            VectorCopy(tr.trBase, result);
+            break;
+        case TR_LINEAR:
+            deltaTime = (atTime - tr.trTime) * 0.001f;  // milliseconds to seconds
+            VectorMA(tr.trBase, deltaTime, tr.trDelta, result);
+            break;
+        case TR_SINE:
+            deltaTime = (atTime - tr.trTime) / static_cast<float>(tr.trDuration);
+            phase = std::sin(deltaTime * PI * 2);
+            VectorMA(tr.trBase, phase, tr.trDelta, result);
+            break;
+        case TR_LINEAR_STOP:
+            if (atTime > tr.trTime + tr.trDuration) {
+                atTime = tr.trTime + tr.trDuration;
+            }
+            deltaTime = (atTime - tr.trTime) * 0.001f;  // milliseconds to seconds
+            if (deltaTime < 0) {
+                deltaTime = 0;
+            }
+            VectorMA(tr.trBase, deltaTime, tr.trDelta, result);
+            break;
+        case TR_NONLINEAR_STOP:
+            if (atTime > tr.trTime + tr.trDuration) {
+                atTime = tr.trTime + tr.trDuration;
+            }
+            // new slow-down at end
+            if (atTime - tr.trTime > tr.trDuration || atTime - tr.trTime <= 0) {
+                deltaTime = 0;
+            } else {
+                float angle = 90.0f - (90.0f * static_cast<float>(atTime - tr.trTime) / static_cast<float>(tr.trDuration));
+                deltaTime = tr.trDuration * 0.001f * std::cos(angle * (PI / 180.0f));
+            }
+            VectorMA(tr.trBase, deltaTime, tr.trDelta, result);
+            break;
+        case TR_GRAVITY:
+            deltaTime = (atTime - tr.trTime) * 0.001f;  // milliseconds to seconds
+            VectorMA(tr.trBase, deltaTime, tr.trDelta, result);
+            result[2] -= 0.5f * DEFAULT_GRAVITY * deltaTime * deltaTime;  // FIXME: local gravity...
+            break;
+        default:
+            // Unknown trType (corrupt or malicious packet)
+            VectorCopy(tr.trBase, result);
+            break;
+        }
+    }
+
+    float LerpAngle(float from, float to, float frac)
+    {
+        if (to - from > 180) {
+            to -= 360;
+        }
+        if (to - from < -180) {
+            to += 360;
+        }
+        return from + frac * (to - from);
+    }
 }
@@ -6,25 +6,26 @@
 #include <JKAProto/packets/AllConnlessPackets.h>
 
 namespace JKA::Packets::ConnlessPacketFactory {
-    std::unique_ptr<ConnlessPacket> parsePacket(std::string_view rawPacket)
+    bool parsePacket(std::string_view rawPacket, ConnlessPacketView & packet) noexcept
     {
+        packet.emplace<std::monostate>();
+
         // The connless packet must have a non-empty name
         if (rawPacket.size() <= CONNLESS_PREFIX_SIZE) {
-            return nullptr;
+            return false;
         }
 
         if (!ConnlessPacket::isConnless(rawPacket)) {
-            return nullptr;
+            return false;
         }
 
-        std::string_view packet = rawPacket.substr(CONNLESS_PREFIX_SIZE);
+        std::string_view data = rawPacket.substr(CONNLESS_PREFIX_SIZE);
 
         // Not a valid algorithm in general, but all JKA packet
         // names consist of alphabetical characters only, so to extract
         // them we need to find the first possible separator
-        size_t possibleSeparatorIdx = packet.find_first_of(CONNLESS_SEPARATORS);
-        std::string_view packetName = packet.substr(0, possibleSeparatorIdx);
-        std::string_view data = "";
+        size_t possibleSeparatorIdx = data.find_first_of(CONNLESS_SEPARATORS);
+        std::string_view packetName = data.substr(0, possibleSeparatorIdx);
 
 #define CONLESS_PACKETS_LIST_ENTRY(type_, cls_name, str, sep)                     \
                 case ct_hash(CONNLESS_PACKETS[type_].name):                       \
@@ -32,11 +33,12 @@ namespace JKA::Packets::ConnlessPacketFactory {
                     if (CONNLESS_PACKETS[type_].name != packetName) {             \
                         break;  /* Collision */                                   \
                     }                                                             \
+                    auto & view = packet.emplace<ConnlessView<type_>>();          \
                     if (!CONNLESS_PACKETS[type_].separator.empty()                \
-                        && possibleSeparatorIdx < packet.size()) {                \
-                        data = packet.substr(possibleSeparatorIdx + 1);           \
+                        && possibleSeparatorIdx < data.size()) {                  \
+                        view.data = data.substr(possibleSeparatorIdx + 1);        \
                     }                                                             \
-                    return cls_name::parse(data);                                 \
+                    return true;                                                  \
                 }
 
         switch (ct_hash(packetName)) {
@@ -46,6 +48,32 @@ namespace JKA::Packets::ConnlessPacketFactory {
 #undef CONLESS_PACKETS_LIST_ENTRY
 
         // Packet name not found / collision
+        return false;
+    }
+
+    std::unique_ptr<ConnlessPacket> parsePacket(std::string_view rawPacket)
+    {
+        ConnlessPacketView packet{};
+        if (!parsePacket(rawPacket, packet)) {
+            return nullptr;
+        }
+        return makePacket(packet);
+    }
+
+    std::unique_ptr<ConnlessPacket> makePacket(const ConnlessPacketView & packet)
+    {
+#define CONLESS_PACKETS_LIST_ENTRY(type_, cls_name, str, sep)                     \
+            case type_:                                                           \
+                return cls_name::parse(std::get<ConnlessView<type_>>(packet).data);
+
+        switch (getType(packet)) {
+            #include <JKAProto/data/ConnlessPacketsList.inc>
+            default:
+                break;
+        }
+
+#undef CONLESS_PACKETS_LIST_ENTRY
+
         return nullptr;
     }
 }
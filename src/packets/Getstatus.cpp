@@ -0,0 +1,249 @@
+#include <JKAProto/packets/Getstatus.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <charconv>
+
+#include <JKAProto/utility/ByteSearch.h>
+
+namespace JKA {
+    namespace {
+        // Finds the next ch, or the next backslash, whichever comes first.
+        // Remembers the last result, so that looking up the same char again
+        // does not rescan the data.
+        class StatusScanner {
+        public:
+            StatusScanner(std::string_view data_, char ch_) noexcept : data(data_), ch(ch_) {}
+
+            size_t next(size_t from) noexcept
+            {
+                if (cachedFrom <= from && from <= cachedIdx) {
+                    return cachedIdx;
+                }
+
+                cachedFrom = from;
+                cachedIdx = Utility::findEither(data, ch, '\\', from);
+                return cachedIdx;
+            }
+
+        private:
+            std::string_view data;
+            char ch;
+            // No ch/backslash in [cachedFrom, cachedIdx)
+            size_t cachedFrom = std::string_view::npos;
+            size_t cachedIdx = 0;
+        };
+    }
+
+    std::string_view ServerStatusView::getInfoField(std::string_view key) const noexcept
+    {
+        // Same rules as JKAInfo::fromInfostring(): the last value of a key wins
+        std::string_view result = "";
+        if (info.size() < 2) {
+            return result;
+        }
+
+        std::string_view currentKey;
+        bool isKey = true;
+        size_t idx = (info[0] == '\\');
+
+        while (idx < info.size()) {
+            size_t nextBackslash = info.find('\\', idx);
+            std::string_view token = info.substr(idx, nextBackslash - idx);
+            if (isKey) {
+                currentKey = token;
+            } else if (std::equal(currentKey.begin(), currentKey.end(), key.begin(), key.end(),
+                                  [](char a, char b) {
+                                      return std::tolower(static_cast<unsigned char>(a)) == b;
+                                  })) {
+                result = token;
+            }
+
+            isKey = !isKey;
+
+            if (nextBackslash == info.npos) {
+                break;
+            }
+            idx = nextBackslash + 1;
+        }
+
+        return result;
+    }
+
+    namespace Packets {
+        bool GetstatusResponse::parseStatus(std::string_view data, ServerStatusView & status)
+        {
+            // Data format is
+            // <infostring>\n<ping1 score1 "player_name1">\n<ping2 score2 "player_name2">\n...
+            // NB: We're trying to somewhat adequately parse newlines in infostring or player names
+            //
+            // The infostring runs up to the first newline after the last backslash of the data.
+            // Instead of looking for the last backslash first, the lines after the infostring
+            // are parsed as soon as a newline is found, and discarded if a backslash shows up.
+
+            constexpr size_t npos = std::string_view::npos;
+            status.info = {};
+            status.players.clear();
+
+            StatusScanner newlines(data, '\n');
+            StatusScanner quotes(data, '"');
+            auto isBackslash = [&data](size_t idx) {
+                return idx < data.size() && data[idx] == '\\';
+            };
+
+            bool backslashFound = false;
+            size_t infoEnd = 0;
+            size_t pos = 0;  // Where the infostring might continue
+
+            while (true) {
+                size_t sepIdx = newlines.next(pos);
+                while (isBackslash(sepIdx)) {
+                    backslashFound = true;
+                    sepIdx = newlines.next(sepIdx + 1);
+                }
+
+                infoEnd = std::min(sepIdx, data.size());
+                status.players.clear();
+                // Treat any malformed line as part of an infostring
+                // until valid playerStatus line is found
+                bool validPlayerParsed = false;
+                size_t backslashIdx = npos;
+
+                while (sepIdx < data.size()) {
+                    size_t lineIdx = sepIdx + 1;
+                    if (lineIdx == data.size()) {
+                        break;  // The last line has ended, there is no empty one after it
+                    }
+
+                    sepIdx = newlines.next(lineIdx);  // Find the end of current line;
+                                                      // sepIdx could be advanced past the end of a player's nickname
+                                                      // if the player has \n in their name
+                    size_t firstQuoteIdx = quotes.next(lineIdx);
+                    if (isBackslash(sepIdx) || isBackslash(firstQuoteIdx)) {
+                        backslashIdx = std::min(sepIdx, firstQuoteIdx);
+                        break;
+                    }
+
+                    // N.B.: some players (hackers) may have '\n' (the separator) in their
+                    // names, so we should find the real end of a player's name (it would always be surrounded by ")
+
+                    if ((firstQuoteIdx != npos && firstQuoteIdx > sepIdx)
+                        || (firstQuoteIdx == lineIdx)) {
+                        // The first quote char is found, but it is either past the newline characted
+                        // or in the beginning of the line (missing score and ping),
+                        // so current line is malformed
+                        if (!validPlayerParsed) {
+                            // Treat malformed line as part of infostring
+                            infoEnd = std::min(sepIdx, data.size());
+                        }
+                        continue;
+                    }
+
+                    if (firstQuoteIdx == npos) {
+                        // No start of player name in the whole data, parsing is done
+                        if (!validPlayerParsed) {
+                            infoEnd = std::min(sepIdx, data.size());
+                        }
+                        break;
+                    }
+
+                    size_t secondQuoteIdx = quotes.next(firstQuoteIdx + 1);
+                    if (isBackslash(secondQuoteIdx)) {
+                        backslashIdx = secondQuoteIdx;
+                        break;
+                    }
+
+                    if (secondQuoteIdx == npos) {
+                        // No end of player name in the whole data, parsing is done
+                        if (!validPlayerParsed) {
+                            infoEnd = std::min(sepIdx, data.size());
+                        }
+                        break;
+                    }
+
+                    size_t nextLineIdx = secondQuoteIdx + 1;
+                    auto line = data.substr(lineIdx, nextLineIdx - lineIdx);
+                    auto player = parsePlayer(line, firstQuoteIdx - lineIdx, secondQuoteIdx - lineIdx);
+                    if (player.valid) {
+                        status.players.push_back(player);
+                        validPlayerParsed = true;
+
+                        sepIdx = nextLineIdx;  // Move sepIdx past the end of player's name
+                        if (isBackslash(sepIdx)) {
+                            backslashIdx = sepIdx;
+                            break;
+                        }
+                    } else {
+                        if (!validPlayerParsed) {
+                            // Treat malformed line as part of infostring
+                            infoEnd = std::min(sepIdx, data.size());
+                        } else {
+                            // Treat malformed line as a partial player info
+                            // (e.g. '1 xxx "Name"' -> we could at least display score and name)
+                            status.players.push_back(player);
+                        }
+                    }
+                }
+
+                if (backslashIdx == npos) {
+                    break;
+                }
+
+                // Everything up to this backslash is a part of the infostring
+                backslashFound = true;
+                pos = backslashIdx + 1;
+            }
+
+            if (!backslashFound) {
+                status.players.clear();
+                return false;
+            }
+
+            status.info = data.substr(0, infoEnd);
+            return true;
+        }
+
+        ServerStatusView::PlayerStatus GetstatusResponse::parsePlayer(std::string_view playerString,
+                                                                      size_t firstQuoteIdx,
+                                                                      size_t secondQuoteIdx) noexcept
+        {
+            assert(firstQuoteIdx < secondQuoteIdx);
+            assert(secondQuoteIdx < playerString.size());
+
+            ServerStatusView::PlayerStatus player{};
+            bool valid = true;
+            player.name = playerString.substr(firstQuoteIdx + 1, secondQuoteIdx - firstQuoteIdx - 1);
+
+            size_t spaceIdx = playerString.find(' ');
+            if (spaceIdx == playerString.npos) {
+                return player;
+            }
+
+            // Parse score
+            player.scoreStr = playerString.substr(0, spaceIdx);
+            auto res = std::from_chars(player.scoreStr.data(), player.scoreStr.data() + player.scoreStr.size(), player.score);
+            if (res.ec != std::errc()) {  // Parsing error
+                valid = false;
+            }
+
+            // Remove score
+            playerString.remove_prefix(spaceIdx + 1);
+
+            spaceIdx = playerString.find(' ');
+            if (spaceIdx == playerString.npos) {
+                return player;
+            }
+
+            // Parse ping
+            player.pingStr = playerString.substr(0, spaceIdx);
+            res = std::from_chars(player.pingStr.data(), player.pingStr.data() + player.pingStr.size(), player.ping);
+            if (res.ec != std::errc()) {  // Parsing error
+                valid = false;
+            }
+
+            player.valid = valid;
+            return player;
+        }
+    }
+}
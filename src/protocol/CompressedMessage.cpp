@@ -64,7 +64,8 @@ namespace JKA::Protocol {
 
     // ************************** DELTA **************************
     // TODO: rww: get rid of aliasing
-    void CompressedMessage::readDeltaEntity(const entityState_t *from, entityState_t *to, int number) noexcept
+    void CompressedMessage::readDeltaEntity(const entityState_t *from, entityState_t *to, int number,
+                                            EntityFieldMask *changedFields) noexcept
     {
         assert(from != nullptr);
         assert(to != nullptr);
@@ -72,6 +73,10 @@ namespace JKA::Protocol {
 
         constexpr size_t TOTAL_FIELDS = entityStateFields.size();
 
+        if (changedFields != nullptr) {
+            changedFields->reset();
+        }
+
         // check for a remove
         if (readBit() == 1) {
             std::memset(to, 0, sizeof(*to));
@@ -102,6 +107,10 @@ namespace JKA::Protocol {
                 // no change
                 *toF = *fromF;
             } else {
+                if (changedFields != nullptr) {
+                    changedFields->set(i);
+                }
+
                 if (field->bits == 0) {
                     // float
                     if (readBit() == 0) {
@@ -242,25 +251,22 @@ namespace JKA::Protocol {
     {
         const netField_t *field = nullptr;
         const netField_t *PSFields = playerStateFields.data();
-        playerState_t dummy = {};
 
+        // rww: the unchanged fields are taken from a full copy of the base,
+        // which is skipped if the delta is applied over the base in place
         if (!from) {
-            from = &dummy;
+            *to = {};
+        } else if (from != to) {
+            *to = *from;
         }
-        *to = *from;
 
-        size_t numFields = 0;
+        // Fields past lc are unchanged, so only the table is needed
         if (isVehiclePS) {  // a vehicle playerstate
-            numFields = vehPlayerStateFields.size();
             PSFields = vehPlayerStateFields.data();
         } else {
             int32_t isPilot = readBit();
             if (isPilot) {  // pilot riding *inside* a vehicle!
-                // Skinpack: I have absolutely no idea what 82 is.
-                numFields = pilotPlayerStateFields.size() - 82;
                 PSFields = pilotPlayerStateFields.data();
-            } else {  // normal client
-                numFields = playerStateFields.size();
             }
         }
 
@@ -272,13 +278,9 @@ namespace JKA::Protocol {
 
         field = PSFields;
         for (size_t i = 0; i < lc; i++, field++) {
-            const int32_t *fromF = reinterpret_cast<const int32_t *>(reinterpret_cast<const uint8_t *>(from) + field->offset);
             int32_t *toF = reinterpret_cast<int32_t *>(reinterpret_cast<uint8_t *>(to) + field->offset);
 
-            if (!readBit()) {
-                // no change
-                *toF = *fromF;
-            } else {
+            if (readBit()) {
                 if (field->bits == 0) {
                     // float
                     if (readBit() == 0) {
@@ -298,14 +300,6 @@ namespace JKA::Protocol {
             }
         }
 
-        field = &PSFields[lc];
-        for (size_t i = lc; i < numFields; i++, field++) {
-            const int32_t *fromF = reinterpret_cast<const int32_t *>(reinterpret_cast<const uint8_t *>(from) + field->offset);
-            int32_t *toF = reinterpret_cast<int32_t *>(reinterpret_cast<uint8_t *>(to) + field->offset);
-            // no change
-            *toF = *fromF;
-        }
-
         // read the arrays
         if (readBit()) {
             // parse stats